@@ -0,0 +1,297 @@
+#pragma once
+
+// Reference queues used by bench_channel. Every adapter exposes the same
+// small interface so each benchmark scenario can run against all of them:
+//
+//   void send(int value);            // blocks while full
+//   std::optional<int> receive();    // nullopt once closed and drained
+//   void close(int consumers);       // called after every producer is done
+//
+// Payloads are non-negative ints. close() receives the consumer count for
+// queues that have no close operation and must wake readers with sentinels.
+
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <channel/channel.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#ifdef CHANNEL_BENCH_WITH_TBB
+#include <tbb/concurrent_queue.h>
+#endif
+
+namespace baseline {
+
+[[noreturn]] inline void throwErrno(const char* what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+// The library itself, with the default lock or the priority-inheritance
+// one.
+template <int Capacity, class Mutex = std::mutex>
+class ChannelQueue {
+ public:
+  static constexpr const char* kName =
+      std::is_same_v<Mutex, PiMutex> ? "Channel (PiMutex)" : "Channel";
+
+  explicit ChannelQueue(std::size_t /*capacity*/) {}
+
+  void send(int value) { channel_.send(value); }
+  std::optional<int> receive() { return channel_.receive(); }
+  void close(int /*consumers*/) { channel_.close(); }
+
+ private:
+  Channel<int, Capacity, SlotLayout::Packed, Mutex> channel_;
+};
+
+// The textbook bounded queue: std::deque behind one mutex and two
+// condition variables, notifying one waiter per operation.
+class MutexDequeQueue {
+ public:
+  static constexpr const char* kName = "std::deque + mutex";
+
+  explicit MutexDequeQueue(std::size_t capacity) : capacity_(capacity) {}
+
+  void send(int value) {
+    {
+      std::unique_lock<std::mutex> lk(mutex_);
+      notFull_.wait(lk, [&]() { return items_.size() < capacity_; });
+      items_.push_back(value);
+    }
+    notEmpty_.notify_one();
+  }
+
+  std::optional<int> receive() {
+    int value;
+    {
+      std::unique_lock<std::mutex> lk(mutex_);
+      notEmpty_.wait(lk, [&]() { return !items_.empty() || closed_; });
+      if (items_.empty()) return std::nullopt;
+      value = items_.front();
+      items_.pop_front();
+    }
+    notFull_.notify_one();
+    return value;
+  }
+
+  void close(int /*consumers*/) {
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      closed_ = true;
+    }
+    notEmpty_.notify_all();
+  }
+
+ private:
+  const std::size_t capacity_;
+  std::mutex mutex_;
+  std::condition_variable notFull_;
+  std::condition_variable notEmpty_;
+  std::deque<int> items_;
+  bool closed_{false};
+};
+
+// A kernel pipe. Writes of at most PIPE_BUF bytes are atomic, so several
+// producers and consumers can share it as long as each message is written
+// and read whole. Closing the write end gives readers EOF. Capacity is the
+// pipe buffer (at least one page), not the requested item count.
+class PipeQueue {
+ public:
+  static constexpr const char* kName = "pipe(2)";
+
+  explicit PipeQueue(std::size_t capacity) {
+    if (::pipe(fds_) != 0) throwErrno("pipe");
+    // Best effort; the kernel rounds up to a page.
+    ::fcntl(fds_[1], F_SETPIPE_SZ, static_cast<int>(capacity * sizeof(int)));
+  }
+  ~PipeQueue() {
+    ::close(fds_[0]);
+    if (fds_[1] >= 0) ::close(fds_[1]);
+  }
+
+  void send(int value) {
+    while (::write(fds_[1], &value, sizeof(value)) != sizeof(value)) {
+      if (errno != EINTR) throwErrno("write");
+    }
+  }
+
+  std::optional<int> receive() {
+    int value;
+    while (true) {
+      const ssize_t got = ::read(fds_[0], &value, sizeof(value));
+      if (got == sizeof(value)) return value;
+      if (got == 0) return std::nullopt;
+      if (got < 0 && errno != EINTR) throwErrno("read");
+    }
+  }
+
+  void close(int /*consumers*/) {
+    ::close(fds_[1]);
+    fds_[1] = -1;
+  }
+
+ private:
+  int fds_[2]{-1, -1};
+};
+
+// A bounded lock-free MPMC ring (Vyukov's sequence-numbered cells) with two
+// eventfd semaphores counting items and free slots, so blocking happens in
+// the kernel instead of on a mutex. A slot token is always taken before a
+// push and an item token before a pop, so the ring itself never fails
+// while open. close() posts a flood of item tokens; a consumer whose pop
+// then finds the ring empty knows every producer has finished.
+class EventfdRingQueue {
+ public:
+  static constexpr const char* kName = "eventfd + lock-free ring";
+
+  explicit EventfdRingQueue(std::size_t capacity)
+      : mask_(roundUpPow2(capacity) - 1), cells_(mask_ + 1) {
+    for (std::size_t i = 0; i <= mask_; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    items_ = ::eventfd(0, EFD_SEMAPHORE);
+    spaces_ = ::eventfd(static_cast<unsigned>(mask_ + 1), EFD_SEMAPHORE);
+    if (items_ < 0 || spaces_ < 0) throwErrno("eventfd");
+  }
+  ~EventfdRingQueue() {
+    ::close(items_);
+    ::close(spaces_);
+  }
+
+  void send(int value) {
+    take(spaces_);
+    push(value);
+    post(items_, 1);
+  }
+
+  std::optional<int> receive() {
+    take(items_);
+    while (true) {
+      if (auto value = pop()) {
+        post(spaces_, 1);
+        return value;
+      }
+      // An item token can arrive before a slower producer ahead of it in the
+      // ring has finished writing; only a closed queue is really empty.
+      if (closed_.load(std::memory_order_acquire)) return std::nullopt;
+    }
+  }
+
+  void close(int /*consumers*/) {
+    closed_.store(true, std::memory_order_release);
+    post(items_, uint64_t{1} << 40);
+  }
+
+ private:
+  struct Cell {
+    std::atomic<std::size_t> sequence{0};
+    int value{0};
+  };
+
+  static std::size_t roundUpPow2(std::size_t n) {
+    std::size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+  }
+
+  static void take(int fd) {
+    uint64_t token;
+    while (::read(fd, &token, sizeof(token)) != sizeof(token)) {
+      if (errno != EINTR) throwErrno("eventfd read");
+    }
+  }
+
+  static void post(int fd, uint64_t count) {
+    while (::write(fd, &count, sizeof(count)) != sizeof(count)) {
+      if (errno != EINTR) throwErrno("eventfd write");
+    }
+  }
+
+  void push(int value) {
+    std::size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells_[pos & mask_];
+      const std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+      const auto diff =
+          static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+      if (diff == 0 && enqueuePos_.compare_exchange_weak(
+                           pos, pos + 1, std::memory_order_relaxed)) {
+        cell.value = value;
+        cell.sequence.store(pos + 1, std::memory_order_release);
+        return;
+      }
+      if (diff != 0) pos = enqueuePos_.load(std::memory_order_relaxed);
+    }
+  }
+
+  std::optional<int> pop() {
+    std::size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells_[pos & mask_];
+      const std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::intptr_t>(seq) -
+                        static_cast<std::intptr_t>(pos + 1);
+      if (diff == 0 && dequeuePos_.compare_exchange_weak(
+                           pos, pos + 1, std::memory_order_relaxed)) {
+        const int value = cell.value;
+        cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return value;
+      }
+      if (diff < 0) return std::nullopt;
+      if (diff != 0) pos = dequeuePos_.load(std::memory_order_relaxed);
+    }
+  }
+
+  const std::size_t mask_;
+  std::vector<Cell> cells_;
+  alignas(64) std::atomic<std::size_t> enqueuePos_{0};
+  alignas(64) std::atomic<std::size_t> dequeuePos_{0};
+  std::atomic<bool> closed_{false};
+  int items_{-1};
+  int spaces_{-1};
+};
+
+#ifdef CHANNEL_BENCH_WITH_TBB
+// oneTBB's bounded queue. It has no close, so close() pushes one negative
+// sentinel per consumer.
+class TbbBoundedQueue {
+ public:
+  static constexpr const char* kName = "tbb::concurrent_bounded_queue";
+
+  explicit TbbBoundedQueue(std::size_t capacity) {
+    queue_.set_capacity(static_cast<std::ptrdiff_t>(capacity));
+  }
+
+  void send(int value) { queue_.push(value); }
+
+  std::optional<int> receive() {
+    int value;
+    queue_.pop(value);
+    if (value < 0) return std::nullopt;
+    return value;
+  }
+
+  void close(int consumers) {
+    for (int i = 0; i < consumers; ++i) queue_.push(-1);
+  }
+
+ private:
+  tbb::concurrent_bounded_queue<int> queue_;
+};
+#endif
+
+}  // namespace baseline
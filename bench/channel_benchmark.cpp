@@ -1,5 +1,7 @@
 #include <channel/channel.hpp>
 
+#include "baseline_queues.hpp"
+
 #include <atomic>
 #include <chrono>
 #include <cmath>
@@ -14,6 +16,7 @@ namespace {
 
 struct BenchmarkResult {
   std::string label;
+  std::string queue;
   std::size_t messages{0};
   int producers{0};
   int consumers{0};
@@ -27,18 +30,19 @@ struct BenchmarkResult {
   }
 };
 
-template <int Capacity>
+template <class Queue>
 BenchmarkResult runScenario(std::string label, std::size_t messages,
-                            int producers, int consumers) {
+                            int producers, int consumers, int capacity) {
   BenchmarkResult result{
       .label = std::move(label),
+      .queue = Queue::kName,
       .messages = messages,
       .producers = producers,
       .consumers = consumers,
-      .capacity = Capacity,
+      .capacity = capacity,
   };
 
-  Channel<int, Capacity> channel;
+  Queue channel(static_cast<std::size_t>(capacity));
   std::atomic<std::size_t> consumed{0};
 
   auto start = std::chrono::steady_clock::now();
@@ -75,7 +79,7 @@ BenchmarkResult runScenario(std::string label, std::size_t messages,
   for (auto& t : producerThreads) {
     t.join();
   }
-  channel.close();
+  channel.close(consumers);
 
   for (auto& t : consumerThreads) {
     t.join();
@@ -89,8 +93,30 @@ BenchmarkResult runScenario(std::string label, std::size_t messages,
   return result;
 }
 
+// Runs one scenario against the library and every baseline queue.
+template <int Capacity>
+void runAllQueues(std::vector<BenchmarkResult>& results,
+                  const std::string& label, std::size_t messages,
+                  int producers, int consumers) {
+  results.push_back(runScenario<baseline::ChannelQueue<Capacity>>(
+      label, messages, producers, consumers, Capacity));
+  results.push_back(runScenario<baseline::ChannelQueue<Capacity, PiMutex>>(
+      label, messages, producers, consumers, Capacity));
+  results.push_back(runScenario<baseline::MutexDequeQueue>(
+      label, messages, producers, consumers, Capacity));
+  results.push_back(runScenario<baseline::PipeQueue>(
+      label, messages, producers, consumers, Capacity));
+  results.push_back(runScenario<baseline::EventfdRingQueue>(
+      label, messages, producers, consumers, Capacity));
+#ifdef CHANNEL_BENCH_WITH_TBB
+  results.push_back(runScenario<baseline::TbbBoundedQueue>(
+      label, messages, producers, consumers, Capacity));
+#endif
+}
+
 void printResult(const BenchmarkResult& result) {
   std::cout << "\nScenario: " << result.label << '\n';
+  std::cout << "  queue         : " << result.queue << '\n';
   std::cout << "  messages      : " << result.messages << '\n';
   std::cout << "  producers     : " << result.producers << '\n';
   std::cout << "  consumers     : " << result.consumers << '\n';
@@ -108,16 +134,14 @@ int main() {
   constexpr std::size_t messages = 200'000;
 
   std::vector<BenchmarkResult> results;
-  results.reserve(3);
 
-  results.push_back(
-      runScenario<1>("Single producer/consumer (capacity 1)", messages, 1, 1));
+  runAllQueues<1>(results, "Single producer/consumer (capacity 1)", messages,
+                  1, 1);
 
-  results.push_back(runScenario<4>("Dual producers/consumers (capacity 4)",
-                                   messages, 2, 2));
+  runAllQueues<4>(results, "Dual producers/consumers (capacity 4)", messages,
+                  2, 2);
 
-  results.push_back(
-      runScenario<16>("Fan-in/out (capacity 16)", messages, 4, 4));
+  runAllQueues<16>(results, "Fan-in/out (capacity 16)", messages, 4, 4);
 
   std::cout << "Channel throughput benchmark\n";
   std::cout << "=============================\n";
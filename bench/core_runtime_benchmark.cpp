@@ -0,0 +1,142 @@
+#include <channel/channel.hpp>
+#include <channel/core_runtime.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Message passing between workers: a fixed set of tokens hops from worker
+// to worker, each hop being a small task. CoreRuntime sends every hop over
+// the direct link to the next core; the baseline pushes every hop through
+// one shared Channel that all workers receive from.
+
+namespace {
+
+constexpr int kHops = 20000;
+
+struct BenchmarkResult {
+  std::string label;
+  std::size_t workers{0};
+  std::size_t tokens{0};
+  std::size_t tasks{0};
+  std::chrono::duration<double> elapsed{};
+
+  double throughput() const {
+    if (elapsed.count() == 0.0) return 0.0;
+    return static_cast<double>(tasks) / elapsed.count();
+  }
+};
+
+BenchmarkResult runMesh(std::size_t workers, std::size_t tokens) {
+  CoreRuntimeOptions options;
+  options.cores = workers;
+  CoreRuntime runtime(options);
+
+  std::function<void(int)> hop = [&](int left) {
+    if (left == 0) return;
+    const auto next = (CoreRuntime::current_core() + 1) % workers;
+    runtime.submit_to(next, [&hop, left]() { hop(left - 1); });
+  };
+
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t t = 0; t < tokens; ++t) {
+    runtime.submit_to(t % workers, [&hop]() { hop(kHops); });
+  }
+  runtime.wait_idle();
+  const auto finish = std::chrono::steady_clock::now();
+
+  BenchmarkResult result;
+  result.label = "CoreRuntime SPSC mesh";
+  result.workers = workers;
+  result.tokens = tokens;
+  result.tasks = tokens * (kHops + 1);
+  result.elapsed =
+      std::chrono::duration_cast<std::chrono::duration<double>>(finish - start);
+  return result;
+}
+
+BenchmarkResult runSharedChannel(std::size_t workers, std::size_t tokens) {
+  // Hops replace themselves, so the channel never holds more than
+  // `tokens` tasks and workers cannot block each other on send.
+  Channel<std::function<void()>, 1024> channel;
+  std::atomic<std::size_t> finished{0};
+
+  std::function<void(int)> hop = [&](int left) {
+    if (left == 0) {
+      finished.fetch_add(1);
+      return;
+    }
+    channel.send([&hop, left]() { hop(left - 1); });
+  };
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (std::size_t w = 0; w < workers; ++w) {
+    threads.emplace_back([&]() {
+      while (auto task = channel.receive()) {
+        (*task)();
+      }
+    });
+  }
+  for (std::size_t t = 0; t < tokens; ++t) {
+    channel.send([&hop]() { hop(kHops); });
+  }
+  while (finished.load() < tokens) {
+    std::this_thread::yield();
+  }
+  const auto finish = std::chrono::steady_clock::now();
+  channel.close();
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  BenchmarkResult result;
+  result.label = "Shared Channel";
+  result.workers = workers;
+  result.tokens = tokens;
+  result.tasks = tokens * (kHops + 1);
+  result.elapsed =
+      std::chrono::duration_cast<std::chrono::duration<double>>(finish - start);
+  return result;
+}
+
+void printResult(const BenchmarkResult& result) {
+  std::cout << "\nScenario: " << result.label << '\n';
+  std::cout << "  workers       : " << result.workers << '\n';
+  std::cout << "  tokens        : " << result.tokens << '\n';
+  std::cout << "  tasks         : " << result.tasks << '\n';
+  std::cout << "  elapsed (s)   : " << std::fixed << std::setprecision(6)
+            << result.elapsed.count() << '\n';
+  std::cout << "  throughput/s  : " << std::fixed << std::setprecision(2)
+            << result.throughput() << '\n';
+}
+
+}  // namespace
+
+int main() {
+  const std::size_t workers =
+      std::max(2u, std::thread::hardware_concurrency());
+
+  std::vector<BenchmarkResult> results;
+  for (std::size_t tokensPerWorker : {1, 16}) {
+    const std::size_t tokens = workers * tokensPerWorker;
+    results.push_back(runSharedChannel(workers, tokens));
+    results.push_back(runMesh(workers, tokens));
+  }
+
+  std::cout << "Thread-per-core benchmark (" << kHops
+            << " hops per token)\n";
+  std::cout << "=============================================\n";
+  for (const auto& result : results) {
+    printResult(result);
+  }
+
+  std::cout << std::endl;
+  return 0;
+}
@@ -0,0 +1,150 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <channel/fd_bridge.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// Pushes a byte stream through a Channel<PageBuffer> into a pipe and compares
+// three ways of draining it: one write(2) per buffer, FdBridge in writev mode
+// and FdBridge in splice mode. The pipe's reader splices everything to
+// /dev/null so its cost is the same for every writer and never copies.
+
+namespace {
+
+constexpr int kCapacity = 16;
+constexpr std::size_t kTotalBytes = std::size_t{512} << 20;
+
+struct BenchmarkResult {
+  std::string label;
+  std::size_t bufferSize{0};
+  std::size_t bytes{0};
+  std::chrono::duration<double> elapsed{};
+
+  double gibPerSecond() const {
+    if (elapsed.count() == 0.0) return 0.0;
+    return static_cast<double>(bytes) / elapsed.count() / (1 << 30);
+  }
+};
+
+[[noreturn]] void throwErrno(const char* what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+// Reads the pipe to EOF by splicing into /dev/null.
+void sinkToDevNull(int pipeRead) {
+  const int devNull = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+  if (devNull < 0) throwErrno("open /dev/null");
+  while (true) {
+    const ssize_t moved =
+        ::splice(pipeRead, nullptr, devNull, nullptr, 1 << 20, SPLICE_F_MOVE);
+    if (moved == 0) break;
+    if (moved < 0 && errno != EINTR) throwErrno("splice");
+  }
+  ::close(devNull);
+}
+
+void produce(Channel<PageBuffer, kCapacity>& channel, std::size_t bufferSize) {
+  for (std::size_t sent = 0; sent < kTotalBytes; sent += bufferSize) {
+    PageBuffer buffer(bufferSize);
+    std::memset(buffer.data(), static_cast<int>(sent & 0xff), bufferSize);
+    buffer.resize(bufferSize);
+    channel.send(std::move(buffer));
+  }
+  channel.close();
+}
+
+void drainWithWrite(Channel<PageBuffer, kCapacity>& channel, int fd) {
+  while (auto buffer = channel.receive()) {
+    std::size_t offset = 0;
+    while (offset < buffer->size()) {
+      const ssize_t n =
+          ::write(fd, buffer->data() + offset, buffer->size() - offset);
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        throwErrno("write");
+      }
+      offset += static_cast<std::size_t>(n);
+    }
+  }
+}
+
+template <typename Drain>
+BenchmarkResult runScenario(std::string label, std::size_t bufferSize,
+                            Drain drain) {
+  int fds[2];
+  if (::pipe2(fds, O_CLOEXEC) != 0) throwErrno("pipe2");
+  ::fcntl(fds[1], F_SETPIPE_SZ, 1 << 20);
+
+  Channel<PageBuffer, kCapacity> channel;
+  const auto start = std::chrono::steady_clock::now();
+
+  std::thread reader([&]() { sinkToDevNull(fds[0]); });
+  std::thread producer([&]() { produce(channel, bufferSize); });
+  drain(channel, fds[1]);
+  ::close(fds[1]);
+  producer.join();
+  reader.join();
+  ::close(fds[0]);
+
+  const auto finish = std::chrono::steady_clock::now();
+
+  BenchmarkResult result;
+  result.label = std::move(label);
+  result.bufferSize = bufferSize;
+  result.bytes = kTotalBytes / bufferSize * bufferSize;
+  result.elapsed =
+      std::chrono::duration_cast<std::chrono::duration<double>>(finish - start);
+  return result;
+}
+
+void printResult(const BenchmarkResult& result) {
+  std::cout << "\nScenario: " << result.label << '\n';
+  std::cout << "  buffer size   : " << result.bufferSize / 1024 << " KiB\n";
+  std::cout << "  bytes         : " << result.bytes << '\n';
+  std::cout << "  elapsed (s)   : " << std::fixed << std::setprecision(6)
+            << result.elapsed.count() << '\n';
+  std::cout << "  GiB/s         : " << std::fixed << std::setprecision(2)
+            << result.gibPerSecond() << '\n';
+}
+
+}  // namespace
+
+int main() {
+  std::vector<BenchmarkResult> results;
+  for (std::size_t kib : {16, 256}) {
+    const std::size_t bufferSize = kib << 10;
+    results.push_back(runScenario(
+        "write(2) per buffer", bufferSize,
+        [](Channel<PageBuffer, kCapacity>& ch, int fd) {
+          drainWithWrite(ch, fd);
+        }));
+    results.push_back(runScenario(
+        "FdBridge writev", bufferSize,
+        [](Channel<PageBuffer, kCapacity>& ch, int fd) {
+          FdBridge<kCapacity>(fd, {FdBridgeMode::Writev, 16}).drain(ch);
+        }));
+    results.push_back(runScenario(
+        "FdBridge splice", bufferSize,
+        [](Channel<PageBuffer, kCapacity>& ch, int fd) {
+          FdBridge<kCapacity>(fd, {FdBridgeMode::Splice, 16}).drain(ch);
+        }));
+  }
+
+  std::cout << "FdBridge benchmark (" << (kTotalBytes >> 20)
+            << " MiB through a pipe)\n";
+  std::cout << "=============================================\n";
+  for (const auto& result : results) {
+    printResult(result);
+  }
+
+  std::cout << std::endl;
+  return 0;
+}
@@ -0,0 +1,136 @@
+#include <channel/channel.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Compares the SlotLayout options for payloads smaller than, about a
+// quarter of and larger than a cache line. Every scenario runs the same
+// many-producer, many-consumer workload; only the slot placement changes.
+
+namespace {
+
+constexpr int kCapacity = 64;
+constexpr int kProducers = 4;
+constexpr int kConsumers = 4;
+
+template <std::size_t Bytes>
+struct Payload {
+  uint64_t words[Bytes / sizeof(uint64_t)]{};
+};
+
+struct BenchmarkResult {
+  std::string label;
+  std::string layout;
+  std::size_t payloadBytes{0};
+  std::size_t messages{0};
+  std::chrono::duration<double> elapsed{};
+
+  double throughput() const {
+    if (elapsed.count() == 0.0) return 0.0;
+    return static_cast<double>(messages) / elapsed.count();
+  }
+};
+
+const char* layoutName(SlotLayout layout) {
+  switch (layout) {
+    case SlotLayout::Packed:
+      return "Packed";
+    case SlotLayout::Padded:
+      return "Padded";
+    case SlotLayout::Scrambled:
+      return "Scrambled";
+  }
+  return "?";
+}
+
+template <class T, SlotLayout Layout>
+BenchmarkResult runScenario(std::string label, std::size_t messages) {
+  Channel<T, kCapacity, Layout> channel;
+  const std::size_t perProducer = messages / kProducers;
+  const auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> consumers;
+  std::vector<uint64_t> checksums(kConsumers, 0);
+  for (int c = 0; c < kConsumers; ++c) {
+    consumers.emplace_back([&, c]() {
+      uint64_t checksum = 0;
+      while (auto value = channel.receive()) {
+        checksum += value->words[0];
+      }
+      checksums[c] = checksum;
+    });
+  }
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&]() {
+      T value;
+      for (std::size_t i = 0; i < perProducer; ++i) {
+        value.words[0] = i;
+        channel.send(value);
+      }
+    });
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+  channel.close();
+  for (auto& t : consumers) {
+    t.join();
+  }
+  const auto finish = std::chrono::steady_clock::now();
+
+  BenchmarkResult result;
+  result.label = std::move(label);
+  result.layout = layoutName(Layout);
+  result.payloadBytes = sizeof(T);
+  result.messages = perProducer * kProducers;
+  result.elapsed =
+      std::chrono::duration_cast<std::chrono::duration<double>>(finish - start);
+  return result;
+}
+
+template <class T>
+void runAllLayouts(std::vector<BenchmarkResult>& results,
+                   const std::string& label, std::size_t messages) {
+  results.push_back(runScenario<T, SlotLayout::Packed>(label, messages));
+  results.push_back(runScenario<T, SlotLayout::Padded>(label, messages));
+  results.push_back(runScenario<T, SlotLayout::Scrambled>(label, messages));
+}
+
+void printResult(const BenchmarkResult& result) {
+  std::cout << "\nScenario: " << result.label << '\n';
+  std::cout << "  layout        : " << result.layout << '\n';
+  std::cout << "  payload bytes : " << result.payloadBytes << '\n';
+  std::cout << "  messages      : " << result.messages << '\n';
+  std::cout << "  elapsed (s)   : " << std::fixed << std::setprecision(6)
+            << result.elapsed.count() << '\n';
+  std::cout << "  throughput/s  : " << std::fixed << std::setprecision(2)
+            << result.throughput() << '\n';
+}
+
+}  // namespace
+
+int main() {
+  constexpr std::size_t messages = 1'000'000;
+
+  std::vector<BenchmarkResult> results;
+  runAllLayouts<Payload<8>>(results, "Small payload", messages);
+  runAllLayouts<Payload<16>>(results, "Quarter-line payload", messages);
+  runAllLayouts<Payload<128>>(results, "Two-line payload", messages);
+
+  std::cout << "Slot layout benchmark (" << kProducers << " producers, "
+            << kConsumers << " consumers, capacity " << kCapacity << ")\n";
+  std::cout << "=============================================\n";
+  for (const auto& result : results) {
+    printResult(result);
+  }
+
+  std::cout << std::endl;
+  return 0;
+}
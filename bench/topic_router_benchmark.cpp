@@ -0,0 +1,193 @@
+#include <channel/channel.hpp>
+#include <channel/topic_router.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Publish throughput against the number of subscriptions. Subscription i
+// follows device i of site i % 10 ("site3/dev13/temp"); every hundredth
+// one instead follows the whole site ("site3/+/temp"). Publishers pick
+// device topics at random from a fixed set of 4096, so each publish
+// reaches one device subscriber plus the site-wide ones. Subscriptions
+// share 64 sink channels drained by a consumer thread.
+//
+// The trie router is run with and without its per-topic cache, next to a
+// baseline that tests the topic against every pattern in turn.
+
+namespace {
+
+using Sink = Channel<int, 1024>;
+
+constexpr std::size_t kSinks = 64;
+constexpr std::size_t kTopics = 4096;
+constexpr auto kRunTime = std::chrono::milliseconds(300);
+
+struct BenchmarkResult {
+  std::string label;
+  std::size_t subscriptions{0};
+  std::size_t publishes{0};
+  std::size_t deliveries{0};
+  std::chrono::duration<double> elapsed{};
+
+  double publishRate() const {
+    if (elapsed.count() == 0.0) return 0.0;
+    return static_cast<double>(publishes) / elapsed.count();
+  }
+
+  double deliveryRate() const {
+    if (elapsed.count() == 0.0) return 0.0;
+    return static_cast<double>(deliveries) / elapsed.count();
+  }
+};
+
+// The hand-written router: one pattern test per subscription.
+class LinearRouter {
+ public:
+  void subscribe(std::string pattern, std::shared_ptr<Sink> sink) {
+    subs_.emplace_back(std::move(pattern), std::move(sink));
+  }
+
+  std::size_t publish(std::string_view topic, int message) {
+    std::size_t delivered = 0;
+    for (const auto& sub : subs_) {
+      if (matches(sub.first, topic)) {
+        sub.second->send(message);
+        ++delivered;
+      }
+    }
+    return delivered;
+  }
+
+ private:
+  static bool matches(std::string_view pattern, std::string_view topic) {
+    while (true) {
+      const auto pEnd = pattern.find('/');
+      const auto tEnd = topic.find('/');
+      const auto pLevel = pattern.substr(0, pEnd);
+      if (pLevel == "#") return true;
+      if (pLevel != "+" && pLevel != topic.substr(0, tEnd)) return false;
+      if (pEnd == std::string_view::npos || tEnd == std::string_view::npos) {
+        if (pEnd == tEnd) return true;
+        // Only a trailing "#" also matches the parent level.
+        return tEnd == std::string_view::npos &&
+               pattern.substr(pEnd + 1) == "#";
+      }
+      pattern.remove_prefix(pEnd + 1);
+      topic.remove_prefix(tEnd + 1);
+    }
+  }
+
+  std::vector<std::pair<std::string, std::shared_ptr<Sink>>> subs_;
+};
+
+std::string devicePattern(std::size_t i) {
+  if (i % 100 == 99) return "site" + std::to_string(i % 10) + "/+/temp";
+  return "site" + std::to_string(i % 10) + "/dev" + std::to_string(i) +
+         "/temp";
+}
+
+template <class Router>
+BenchmarkResult runScenario(const std::string& label, Router& router,
+                            std::size_t subscriptions,
+                            const std::vector<std::shared_ptr<Sink>>& sinks) {
+  for (std::size_t i = 0; i < subscriptions; ++i) {
+    router.subscribe(devicePattern(i), sinks[i % kSinks]);
+  }
+  std::mt19937 rng(42);
+  std::vector<std::string> topics;
+  for (std::size_t t = 0; t < kTopics; ++t) {
+    std::size_t device = rng() % subscriptions;
+    if (device % 100 == 99) --device;
+    topics.push_back(devicePattern(device));
+  }
+
+  std::atomic<bool> done{false};
+  std::thread consumer([&]() {
+    std::vector<int> out;
+    while (!done.load(std::memory_order_relaxed)) {
+      std::size_t got = 0;
+      for (const auto& sink : sinks) {
+        out.clear();
+        got += sink->try_receive_batch(std::back_inserter(out), 1024);
+      }
+      if (got == 0) std::this_thread::yield();
+    }
+  });
+
+  BenchmarkResult result;
+  result.label = label;
+  result.subscriptions = subscriptions;
+  const auto start = std::chrono::steady_clock::now();
+  auto now = start;
+  while (now - start < kRunTime) {
+    for (int i = 0; i < 64; ++i) {
+      result.deliveries +=
+          router.publish(topics[result.publishes % kTopics],
+                         static_cast<int>(result.publishes));
+      ++result.publishes;
+    }
+    now = std::chrono::steady_clock::now();
+  }
+  result.elapsed =
+      std::chrono::duration_cast<std::chrono::duration<double>>(now - start);
+
+  done = true;
+  consumer.join();
+  std::vector<int> out;
+  for (const auto& sink : sinks) {
+    sink->try_receive_batch(std::back_inserter(out), 1024);
+  }
+  return result;
+}
+
+void printResult(const BenchmarkResult& result) {
+  std::cout << "\nScenario: " << result.label << '\n';
+  std::cout << "  Subscriptions: " << result.subscriptions << '\n';
+  std::cout << "  Publishes:     " << result.publishes << '\n';
+  std::cout << "  Deliveries:    " << result.deliveries << '\n';
+  std::cout << "  Elapsed:       " << std::fixed << std::setprecision(3)
+            << result.elapsed.count() << " s\n";
+  std::cout << "  Publishes/s:   " << std::fixed << std::setprecision(0)
+            << result.publishRate() << '\n';
+  std::cout << "  Deliveries/s:  " << std::fixed << std::setprecision(0)
+            << result.deliveryRate() << '\n';
+}
+
+}  // namespace
+
+int main() {
+  std::vector<std::shared_ptr<Sink>> sinks;
+  for (std::size_t s = 0; s < kSinks; ++s) {
+    sinks.push_back(std::make_shared<Sink>());
+  }
+
+  for (const std::size_t subscriptions : {10u, 1000u, 100000u}) {
+    {
+      TopicRouter<Sink> router;
+      printResult(runScenario("TopicRouter (trie + topic cache)", router,
+                              subscriptions, sinks));
+    }
+    {
+      TopicRouter<Sink> router(TopicRouterOptions{0});
+      printResult(runScenario("TopicRouter (trie only)", router,
+                              subscriptions, sinks));
+    }
+    {
+      LinearRouter router;
+      printResult(runScenario("Linear scan baseline", router, subscriptions,
+                              sinks));
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,190 @@
+#include <sys/resource.h>
+
+#include <channel/channel.hpp>
+#include <channel/tsc_clock.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Compares WakePolicy::Broadcast and WakePolicy::Lifo when the producer runs
+// below the consumers' capacity. A paced producer emits a fixed share of what
+// the consumer pool could process; each item costs a short busy loop. Besides
+// throughput we report the process CPU time, how many consumers did a
+// meaningful share of the work (with Lifo, idle consumers should stay parked)
+// and the send-to-receive latency, stamped with TscClock.
+
+namespace {
+
+constexpr int kConsumers = 8;
+constexpr auto kWorkPerItem = std::chrono::microseconds(20);
+constexpr auto kTick = std::chrono::milliseconds(1);
+
+struct BenchmarkResult {
+  std::string label;
+  double load{0.0};
+  std::size_t messages{0};
+  std::chrono::duration<double> elapsed{};
+  double cpuSeconds{0.0};
+  long contextSwitches{0};
+  int activeConsumers{0};
+  double p50LatencyUs{0.0};
+  double p99LatencyUs{0.0};
+
+  double throughput() const {
+    if (elapsed.count() == 0.0) return 0.0;
+    return static_cast<double>(messages) / elapsed.count();
+  }
+};
+
+struct Usage {
+  double cpuSeconds{0.0};
+  long contextSwitches{0};
+};
+
+Usage processUsage() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  auto seconds = [](const timeval& tv) {
+    return static_cast<double>(tv.tv_sec) + tv.tv_usec / 1e6;
+  };
+  return Usage{seconds(usage.ru_utime) + seconds(usage.ru_stime),
+               usage.ru_nvcsw + usage.ru_nivcsw};
+}
+
+void busyWork() {
+  const auto until = std::chrono::steady_clock::now() + kWorkPerItem;
+  while (std::chrono::steady_clock::now() < until) {
+  }
+}
+
+double percentileUs(std::vector<int64_t>& samples, double q) {
+  if (samples.empty()) return 0.0;
+  const auto nth = samples.begin() +
+                   static_cast<std::ptrdiff_t>(q * (samples.size() - 1));
+  std::nth_element(samples.begin(), nth, samples.end());
+  return static_cast<double>(*nth) / 1e3;
+}
+
+BenchmarkResult runScenario(std::string label, WakePolicy policy, double load,
+                            std::chrono::milliseconds duration) {
+  // Items per tick that would keep `load` of the consumer pool busy.
+  const double capacityPerTick =
+      kConsumers * (std::chrono::duration<double>(kTick) /
+                    std::chrono::duration<double>(kWorkPerItem));
+  const auto perTick = std::max<std::size_t>(
+      1, static_cast<std::size_t>(capacityPerTick * load));
+
+  // Each item carries the TscClock reading taken just before its send.
+  Channel<int64_t, 64> channel(ChannelOptions{"", policy});
+  std::vector<std::atomic<std::size_t>> handled(kConsumers);
+  std::vector<std::vector<int64_t>> latencies(kConsumers);
+  TscClock::calibrate();
+
+  const Usage usageBefore = processUsage();
+  const auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> consumers;
+  for (int c = 0; c < kConsumers; ++c) {
+    consumers.emplace_back([&, c]() {
+      while (auto stamp = channel.receive()) {
+        latencies[c].push_back(
+            TscClock::now().time_since_epoch().count() - *stamp);
+        busyWork();
+        handled[c].fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+  }
+
+  std::size_t sent = 0;
+  auto nextTick = start;
+  while (std::chrono::steady_clock::now() - start < duration) {
+    for (std::size_t i = 0; i < perTick; ++i) {
+      channel.send(TscClock::now().time_since_epoch().count());
+      ++sent;
+    }
+    nextTick += kTick;
+    std::this_thread::sleep_until(nextTick);
+  }
+  channel.close();
+  for (auto& t : consumers) {
+    t.join();
+  }
+
+  const auto finish = std::chrono::steady_clock::now();
+  const Usage usageAfter = processUsage();
+
+  BenchmarkResult result;
+  result.label = std::move(label);
+  result.load = load;
+  result.messages = sent;
+  result.elapsed =
+      std::chrono::duration_cast<std::chrono::duration<double>>(finish - start);
+  result.cpuSeconds = usageAfter.cpuSeconds - usageBefore.cpuSeconds;
+  result.contextSwitches =
+      usageAfter.contextSwitches - usageBefore.contextSwitches;
+  for (const auto& count : handled) {
+    // "Active" means doing at least a fair share's tenth of the work.
+    if (count.load() * kConsumers * 10 >= sent) {
+      ++result.activeConsumers;
+    }
+  }
+  std::vector<int64_t> all;
+  for (const auto& perConsumer : latencies) {
+    all.insert(all.end(), perConsumer.begin(), perConsumer.end());
+  }
+  result.p50LatencyUs = percentileUs(all, 0.50);
+  result.p99LatencyUs = percentileUs(all, 0.99);
+  return result;
+}
+
+void printResult(const BenchmarkResult& result) {
+  std::cout << "\nScenario: " << result.label << '\n';
+  std::cout << "  target load   : " << std::fixed << std::setprecision(0)
+            << result.load * 100 << "%\n";
+  std::cout << "  messages      : " << result.messages << '\n';
+  std::cout << "  elapsed (s)   : " << std::fixed << std::setprecision(6)
+            << result.elapsed.count() << '\n';
+  std::cout << "  throughput/s  : " << std::fixed << std::setprecision(2)
+            << result.throughput() << '\n';
+  std::cout << "  cpu time (s)  : " << std::fixed << std::setprecision(6)
+            << result.cpuSeconds << '\n';
+  std::cout << "  ctx switches  : " << result.contextSwitches << '\n';
+  std::cout << "  active cons.  : " << result.activeConsumers << " of "
+            << kConsumers << '\n';
+  std::cout << "  latency p50   : " << std::fixed << std::setprecision(1)
+            << result.p50LatencyUs << " us\n";
+  std::cout << "  latency p99   : " << std::fixed << std::setprecision(1)
+            << result.p99LatencyUs << " us\n";
+}
+
+}  // namespace
+
+int main() {
+  constexpr auto duration = std::chrono::milliseconds(500);
+
+  std::vector<BenchmarkResult> results;
+  for (double load : {0.1, 0.25, 0.5}) {
+    results.push_back(runScenario("Broadcast wakeups", WakePolicy::Broadcast,
+                                  load, duration));
+    results.push_back(
+        runScenario("LIFO wakeups", WakePolicy::Lifo, load, duration));
+  }
+
+  std::cout << "Wake policy benchmark (" << kConsumers << " consumers, "
+            << kWorkPerItem.count() << "us per item)\n";
+  std::cout << "=============================================\n";
+  for (const auto& result : results) {
+    printResult(result);
+  }
+
+  std::cout << std::endl;
+  return 0;
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <channel/tsc_clock.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+struct AdaptiveBatchOptions {
+    std::size_t min_batch{1};
+    std::size_t max_batch{256};
+    // Budget for an item's linger plus the processing of its batch.
+    std::chrono::nanoseconds latency_target{std::chrono::milliseconds(1)};
+    // Weight of the newest sample in the rate and cost averages.
+    double smoothing{0.2};
+    // Nanosecond time source for those measurements; null means
+    // TscClock::precise_ns(). Lets tests drive the batcher deterministically.
+    int64_t (*clock_ns)(){nullptr};
+};
+
+// Consumer-side helper that picks receive_batch sizes and linger times by
+// itself. It keeps moving averages of the channel's arrival rate (from its
+// sent counter) and of the handler's cost per item, and sizes batches so
+// that filling one plus processing it fits the latency target:
+//
+//     batch * (1 / arrival_rate + cost_per_item) <= latency_target
+//
+// lingering just long enough for that many items to arrive. When a batch
+// comes back full and more items are already waiting, the consumer is
+// behind and lingering is pointless; the batch size then doubles (up to
+// what the target allows for processing alone) to take more items per
+// lock acquisition.
+//
+// Works with any Channel configuration. Not thread-safe: use one batcher
+// per consumer thread.
+template <class Ch>
+class AdaptiveBatcher {
+   public:
+    using value_type = typename Ch::value_type;
+
+    explicit AdaptiveBatcher(Ch& channel, AdaptiveBatchOptions options = {})
+        : channel_(channel),
+          options_(options),
+          batch_(std::max<std::size_t>(options.min_batch, 1)) {
+        options_.min_batch = batch_;
+        options_.max_batch = std::max(options_.max_batch, batch_);
+        if (options_.clock_ns == nullptr) {
+            options_.clock_ns = &TscClock::precise_ns;
+            TscClock::calibrate();
+        }
+    }
+
+    // Receives one batch and hands it to fn(std::vector<value_type>&).
+    // Returns the number of items; zero once the channel is closed and
+    // drained.
+    template <class Fn>
+    std::size_t consume(Fn&& fn) {
+        items_.clear();
+        const std::size_t got =
+            channel_.receive_batch_for(std::back_inserter(items_), batch_,
+                                       linger_);
+        if (got == 0) {
+            return 0;
+        }
+        const int64_t started = options_.clock_ns();
+        fn(items_);
+        const int64_t finished = options_.clock_ns();
+        observe(got, finished - started, finished);
+        return got;
+    }
+
+    std::size_t batch_size() const noexcept { return batch_; }
+    std::chrono::nanoseconds linger() const noexcept { return linger_; }
+    // Smoothed arrival rate in items per second.
+    double arrival_rate() const noexcept { return arrival_per_s_; }
+    // Smoothed handler time per item.
+    std::chrono::nanoseconds item_cost() const noexcept {
+        return std::chrono::nanoseconds(static_cast<int64_t>(cost_ns_));
+    }
+
+   private:
+    // Exponential moving average; the first sample is taken as is.
+    double smooth(double average, double sample, bool first) const noexcept {
+        return first ? sample
+                     : average + options_.smoothing * (sample - average);
+    }
+
+    void observe(std::size_t got, int64_t handler_ns, int64_t now_ns) {
+        const uint64_t sent = channel_.stats().sent.load();
+        if (batches_ > 0 && now_ns > last_ns_) {
+            const double rate = static_cast<double>(sent - last_sent_) * 1e9 /
+                                static_cast<double>(now_ns - last_ns_);
+            arrival_per_s_ = smooth(arrival_per_s_, rate, batches_ == 1);
+        }
+        last_sent_ = sent;
+        last_ns_ = now_ns;
+        cost_ns_ = smooth(cost_ns_,
+                          static_cast<double>(handler_ns) /
+                              static_cast<double>(got),
+                          batches_ == 0);
+        ++batches_;
+
+        const auto target =
+            static_cast<double>(options_.latency_target.count());
+        // Largest batch whose processing alone fits the target.
+        const double cap = cost_ns_ > 0.0 ? target / cost_ns_
+                                          : static_cast<double>(
+                                                options_.max_batch);
+        const bool behind =
+            got == batch_ && channel_.stats().occupancy.load() > 0;
+        double next;
+        double gap_ns = 0.0;
+        if (behind) {
+            next = std::min(2.0 * static_cast<double>(batch_), cap);
+        } else {
+            gap_ns = arrival_per_s_ > 0.0 ? 1e9 / arrival_per_s_ : target;
+            next = target / (gap_ns + cost_ns_);
+        }
+        batch_ = std::clamp(static_cast<std::size_t>(std::max(next, 1.0)),
+                            options_.min_batch, options_.max_batch);
+        // Time for the batch to fill, within what processing leaves over.
+        const double budget =
+            std::max(target - static_cast<double>(batch_) * cost_ns_, 0.0);
+        const double fill =
+            batch_ > 1 ? static_cast<double>(batch_ - 1) * gap_ns : 0.0;
+        linger_ = std::chrono::nanoseconds(
+            static_cast<int64_t>(std::min(fill, budget)));
+    }
+
+    Ch& channel_;
+    AdaptiveBatchOptions options_;
+    std::vector<value_type> items_;
+    std::size_t batch_;
+    std::chrono::nanoseconds linger_{0};
+    double arrival_per_s_{0.0};
+    double cost_ns_{0.0};
+    uint64_t batches_{0};
+    uint64_t last_sent_{0};
+    int64_t last_ns_{0};
+};
@@ -1,34 +1,284 @@
+#pragma once
+
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <channel/channel_registry.hpp>
+#include <channel/contention_profiler.hpp>
+#include <channel/pi_mutex.hpp>
+#include <channel/tsc_clock.hpp>
+#include <chrono>
+#include <cmath>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <functional>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
 #include <mutex>
 #include <optional>
 #include <random>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
+
+// Which parked threads a state change wakes.
+enum class WakePolicy {
+    // Every parked thread on the affected side wakes and re-checks.
+    Broadcast,
+    // Only the most recently parked thread wakes, one per item (or free
+    // slot). Under partial load work concentrates on a few cache-warm
+    // threads while the others stay asleep.
+    Lifo,
+};
+
+// How Channel places its slots in memory. Neighbouring slots are touched by
+// threads on different cores one after another, so small payloads packed
+// into one cache line keep bouncing that line between them.
+enum class SlotLayout {
+    // A plain array; densest, best when T fills a cache line by itself.
+    Packed,
+    // Every slot on its own cache line(s); costs memory for small T.
+    Padded,
+    // Packed storage, but consecutive positions are spread over different
+    // cache lines. Falls back to Packed when N is not a multiple of the
+    // slots per line or everything fits in one line.
+    Scrambled,
+};
+
+inline constexpr std::size_t kChannelCacheLine = 64;
+
+// Slot storage for Channel. Positions are logical ring indices; the layout
+// decides where each one lives.
+template <typename T, int N, SlotLayout Layout>
+class ChannelSlots {
+   public:
+    T& operator[](int pos) noexcept {
+        if constexpr (Layout == SlotLayout::Padded) {
+            return slots_[pos].value;
+        } else {
+            return slots_[physical(pos)];
+        }
+    }
+
+   private:
+    struct alignas(kChannelCacheLine) PaddedSlot {
+        T value{};
+    };
+
+    static constexpr int kPerLine =
+        sizeof(T) >= kChannelCacheLine
+            ? 1
+            : static_cast<int>(kChannelCacheLine / sizeof(T));
+    static constexpr int kRows = N / kPerLine;
+    static constexpr bool kScramble = Layout == SlotLayout::Scrambled &&
+                                      kPerLine > 1 && kRows > 1 &&
+                                      N % kPerLine == 0;
+
+    // Treats the buffer as kRows lines of kPerLine slots and walks it
+    // column by column, so kRows consecutive positions hit kRows lines.
+    static constexpr int physical(int pos) noexcept {
+        if constexpr (kScramble) {
+            return (pos % kRows) * kPerLine + pos / kRows;
+        } else {
+            return pos;
+        }
+    }
+
+    using Slot = std::conditional_t<Layout == SlotLayout::Padded, PaddedSlot,
+                                    T>;
+    // Packed keeps the natural alignment so the default Channel is laid out
+    // exactly as a plain array would be.
+    static constexpr std::size_t kAlign = Layout == SlotLayout::Packed
+                                              ? alignof(Slot)
+                                              : kChannelCacheLine;
+    alignas(kAlign) std::array<Slot, N> slots_{};
+};
+
+// Condition variable Channel pairs with its Mutex parameter. Anything other
+// than std::mutex or PiMutex falls back to std::condition_variable_any.
+template <class Mutex>
+struct ChannelCondition {
+    using type = std::condition_variable_any;
+};
+
+template <>
+struct ChannelCondition<std::mutex> {
+    using type = std::condition_variable;
+};
+
+template <>
+struct ChannelCondition<PiMutex> {
+    using type = PiConditionVariable;
+};
 
-template <typename T, int N = 1>
+struct ChannelOptions {
+    // A non-empty name joins ChannelRegistry::instance().
+    std::string name;
+    WakePolicy wake_policy{WakePolicy::Broadcast};
+    // When positive, receivers get at most `rate` items per second on
+    // average and at most `burst` back to back. Items stay buffered (and
+    // senders block on a full buffer) until a token is due.
+    double rate{0.0};
+    std::size_t burst{1};
+    // A positive target turns on CoDel active queue management: once every
+    // item handed out over `codel_interval` waited longer than the target,
+    // receivers drop items at the head, increasingly often, until the
+    // queueing delay is back under it. Dropped items count in stats.
+    std::chrono::nanoseconds codel_target{0};
+    std::chrono::nanoseconds codel_interval{std::chrono::milliseconds(100)};
+    // A positive value turns on adaptive ordering: items go out FIFO, but
+    // once the buffer has stayed non-empty for this long receivers take the
+    // newest item first, until it empties again. Switches are counted in
+    // stats.
+    std::chrono::nanoseconds lifo_after{0};
+    // Where the stats block and CoDel state are allocated; null means the
+    // default resource. The ring itself lives inside the Channel. Must
+    // outlive the channel and any registry snapshot that still holds its
+    // stats.
+    std::pmr::memory_resource* resource{nullptr};
+};
+
+// Mutex guards the buffer. Use PiMutex when real-time threads of different
+// priorities share a channel, so a preempted low-priority owner cannot
+// stall a high-priority sender or receiver indefinitely.
+template <typename T, int N = 1, SlotLayout Layout = SlotLayout::Packed,
+          class Mutex = std::mutex>
 class Channel {
    public:
-    Channel() = default;
+    Channel() : Channel(ChannelOptions{}) {}
+
+    // Named channels join ChannelRegistry::instance() until destroyed.
+    explicit Channel(std::string name)
+        : Channel(ChannelOptions{std::move(name)}) {}
+
+    explicit Channel(ChannelOptions options)
+        : resource_(options.resource != nullptr
+                        ? options.resource
+                        : std::pmr::get_default_resource()),
+          stats_(std::allocate_shared<ChannelStats>(
+              std::pmr::polymorphic_allocator<ChannelStats>(resource_),
+              std::move(options.name), N)),
+          registered_(!stats_->name.empty()),
+          wake_policy_(options.wake_policy),
+          token_interval_ns_(
+              options.rate > 0.0
+                  ? std::max<int64_t>(static_cast<int64_t>(1e9 / options.rate),
+                                      1)
+                  : 0),
+          burst_tolerance_ns_(
+              token_interval_ns_ *
+              static_cast<int64_t>(std::max<std::size_t>(options.burst, 1) -
+                                   1)),
+          lifo_after_ns_(std::max<int64_t>(options.lifo_after.count(), 0)) {
+        if (options.codel_target.count() > 0) {
+            void* raw = resource_->allocate(sizeof(Codel), alignof(Codel));
+            codel_.reset(new (raw) Codel());
+            codel_.get_deleter().resource = resource_;
+            codel_->target_ns = options.codel_target.count();
+            codel_->interval_ns =
+                std::max<int64_t>(options.codel_interval.count(), 1);
+        }
+        if (codel_ || lifo_after_ns_ > 0) {
+            TscClock::calibrate();
+        }
+        if (registered_) {
+            ChannelRegistry::instance().join(stats_);
+        }
+    }
+
+    ~Channel() {
+        if (registered_) {
+            ChannelRegistry::instance().leave(stats_.get());
+        }
+    }
+
     Channel(const Channel& other) = delete;
     Channel& operator=(const Channel& other) = delete;
+    using value_type = T;
+
+    std::pmr::memory_resource* memory_resource() const noexcept {
+        return resource_;
+    }
     enum class SendResult { Success, Full, Closed };
     enum class RecvResult { Success, Empty, Closed };
 
    private:
+    using Lock = std::unique_lock<Mutex>;
+    using CondVar = typename ChannelCondition<Mutex>::type;
+
     std::atomic<int> spaces_available_{N};
     std::atomic<int> receive_pos_{0};
     std::atomic<int> send_pos_{0};
-    std::array<T, N> buffer_{};
+    ChannelSlots<T, N, Layout> buffer_;
     std::atomic<bool> closed_{false};
-    std::mutex data_mutex_;
-    std::condition_variable send_cv_;
-    std::condition_variable receive_cv_;
+    Mutex data_mutex_;
+    CondVar send_cv_;
+    CondVar receive_cv_;
+    std::pmr::memory_resource* const resource_;
+    const std::shared_ptr<ChannelStats> stats_;
+    const bool registered_{false};
+    const WakePolicy wake_policy_{WakePolicy::Broadcast};
+
+    // Receive rate limit as a generic cell rate algorithm: next_token_ns_ is
+    // the theoretical arrival time of the next token on steady_clock (it
+    // doubles as the throttle deadline), and a token may be taken while that
+    // lies at most burst_tolerance_ns_ ahead. Guarded by data_mutex_. A zero
+    // interval means unlimited.
+    const int64_t token_interval_ns_{0};
+    const int64_t burst_tolerance_ns_{0};
+    int64_t next_token_ns_{0};
+    // Rate-limited receivers sleep here until their token is due.
+    CondVar throttle_cv_;
+
+    // CoDel state (RFC 8289), guarded by data_mutex_. Only allocated when
+    // AQM is on, so plain channels neither stamp items nor pay for it.
+    struct Codel {
+        int64_t target_ns{0};
+        int64_t interval_ns{0};
+        // control_now_ns() when each slot was filled.
+        std::array<int64_t, N> enqueued_ns{};
+        // When the head has been above target for a full interval.
+        int64_t first_above_ns{0};
+        int64_t drop_next_ns{0};
+        uint32_t count{0};
+        uint32_t last_count{0};
+        bool dropping{false};
+    };
+    struct CodelDeleter {
+        std::pmr::memory_resource* resource{nullptr};
+
+        void operator()(Codel* codel) const {
+            codel->~Codel();
+            resource->deallocate(codel, sizeof(Codel), alignof(Codel));
+        }
+    };
+    std::unique_ptr<Codel, CodelDeleter> codel_;
+
+    // Adaptive LIFO state, guarded by data_mutex_. Zero threshold = off.
+    const int64_t lifo_after_ns_{0};
+    int64_t nonempty_since_ns_{0};
+    bool lifo_mode_{false};
+
+    // Receivers inside receive_batch_for's linger; guarded by data_mutex_.
+    int lingering_{0};
+
+    // A thread parked under WakePolicy::Lifo. Each one sleeps on its own
+    // condition variable so the waker can pick exactly which thread runs.
+    // Waiters live on the parked thread's stack and form an intrusive
+    // stack per side; they are only touched with data_mutex_ held.
+    struct Waiter {
+        CondVar cv;
+        bool signaled{false};
+        Waiter* below{nullptr};
+    };
+    Waiter* parked_senders_{nullptr};
+    Waiter* parked_receivers_{nullptr};
 
     inline bool is_emtpy() const noexcept {
         return spaces_available_.load() == N;
@@ -41,91 +291,357 @@ class Channel {
         return is_closed() && is_emtpy();
     }
 
-   public:
-    class send_after_close : public std::runtime_error {
-       public:
-        send_after_close(std::string m) : std::runtime_error(m) {}
-    };
+    std::size_t buffered() const noexcept {
+        return static_cast<std::size_t>(N - spaces_available_.load());
+    }
 
-    void send(T& data) {
-        {
-            std::unique_lock<std::mutex> lk(data_mutex_);
-            send_cv_.wait(lk, [&]() {
-                return !is_full() || closed_.load(std::memory_order_relaxed);
-            });
-            if (closed_.load(std::memory_order_relaxed)) {
-                throw send_after_close("Send data after channel closed");
+    static int64_t steady_now_ns() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // Clock for CoDel and adaptive LIFO decisions. Only for comparing
+    // stamps; deadlines come from steady_clock. The constructor calibrates
+    // TscClock, so this never sleeps under the lock.
+    static int64_t control_now_ns() noexcept {
+        return TscClock::precise_ns();
+    }
+
+    // Takes up to `want` tokens at once. When none is available, returns
+    // zero and sets `ready_ns` to when the next one will be.
+    std::size_t take_tokens(std::size_t want, int64_t now_ns,
+                            int64_t& ready_ns) noexcept {
+        const int64_t base = std::max(next_token_ns_, now_ns);
+        const int64_t room =
+            now_ns + burst_tolerance_ns_ + token_interval_ns_ - base;
+        if (room < token_interval_ns_) {
+            ready_ns = base - burst_tolerance_ns_;
+            return 0;
+        }
+        const std::size_t granted = std::min<std::size_t>(
+            want, static_cast<std::size_t>(room / token_interval_ns_));
+        next_token_ns_ =
+            base + static_cast<int64_t>(granted) * token_interval_ns_;
+        return granted;
+    }
+
+    // Gives back tokens granted for items that were then shed instead of
+    // handed out, so AQM drops do not use up the rate budget.
+    void refund_tokens(std::size_t unused) noexcept {
+        next_token_ns_ -= static_cast<int64_t>(unused) * token_interval_ns_;
+    }
+
+    // Grants up to `want` receives under the rate limit. If no token is due
+    // yet, does one timed wait for it (releasing `lk` meanwhile) and returns
+    // zero so the caller re-checks the buffer.
+    std::size_t throttle(Lock& lk, std::size_t want) {
+        if (token_interval_ns_ == 0) {
+            return want;
+        }
+        const int64_t now = steady_now_ns();
+        int64_t ready = 0;
+        const std::size_t granted = take_tokens(want, now, ready);
+        if (granted > 0) {
+            return granted;
+        }
+        throttle_cv_.wait_until(
+            lk, std::chrono::steady_clock::time_point(
+                    std::chrono::duration_cast<
+                        std::chrono::steady_clock::duration>(
+                        std::chrono::nanoseconds(ready))));
+        ChannelStats::add(stats_->throttled_ns,
+                          std::max<int64_t>(steady_now_ns() - now, 0));
+        return 0;
+    }
+
+    // Non-waiting variant for the try_ operations.
+    std::size_t try_throttle(std::size_t want) noexcept {
+        if (token_interval_ns_ == 0) {
+            return want;
+        }
+        int64_t ready = 0;
+        return take_tokens(want, steady_now_ns(), ready);
+    }
+
+    // Both helpers expect data_mutex_ to be held and the buffer to have
+    // room (push) or data (pop).
+    template <class U>
+    void push_locked(U&& data) {
+        const auto pos = send_pos_.load();
+        buffer_[pos] = std::forward<U>(data);
+        if (lifo_after_ns_ > 0 && is_emtpy()) {
+            nonempty_since_ns_ = control_now_ns();
+        }
+        if (codel_) {
+            codel_->enqueued_ns[pos] = control_now_ns();
+        }
+        send_pos_.store((pos + 1) % N);
+        spaces_available_.fetch_sub(1);
+        ChannelStats::add(stats_->sent, 1);
+        ChannelStats::add(stats_->occupancy, 1);
+    }
+
+    T take_head_locked() {
+        const auto pos = receive_pos_.load();
+        T data = std::move(buffer_[pos]);
+        receive_pos_.store((pos + 1) % N);
+        spaces_available_.fetch_add(1);
+        ChannelStats::add(stats_->occupancy, -1);
+        return data;
+    }
+
+    // Newest item, for adaptive LIFO.
+    T take_tail_locked() {
+        const auto pos = (send_pos_.load() + N - 1) % N;
+        T data = std::move(buffer_[pos]);
+        send_pos_.store(pos);
+        spaces_available_.fetch_add(1);
+        ChannelStats::add(stats_->occupancy, -1);
+        return data;
+    }
+
+    void set_lifo_mode(bool lifo) noexcept {
+        if (lifo != lifo_mode_) {
+            lifo_mode_ = lifo;
+            ChannelStats::add(stats_->order_switches, 1);
+        }
+    }
+
+    // Hands out the next item: the oldest, or under an old backlog in
+    // adaptive mode the newest.
+    T pop_locked() {
+        ChannelStats::add(stats_->received, 1);
+        if (lifo_after_ns_ == 0) {
+            return take_head_locked();
+        }
+        const int64_t now = control_now_ns();
+        set_lifo_mode(now - nonempty_since_ns_ >= lifo_after_ns_);
+        T data = lifo_mode_ ? take_tail_locked() : take_head_locked();
+        if (is_emtpy()) {
+            set_lifo_mode(false);
+        }
+        return data;
+    }
+
+    // CoDel's verdict on the current head: true once items have waited
+    // longer than the target for at least an interval. A lone item is
+    // never dropped.
+    bool codel_ok_to_drop(int64_t now) noexcept {
+        Codel& c = *codel_;
+        const int64_t sojourn = now - c.enqueued_ns[receive_pos_.load()];
+        if (sojourn < c.target_ns || buffered() <= 1) {
+            c.first_above_ns = 0;
+            return false;
+        }
+        if (c.first_above_ns == 0) {
+            c.first_above_ns = now + c.interval_ns;
+            return false;
+        }
+        return now >= c.first_above_ns;
+    }
+
+    int64_t codel_control_law(int64_t t, uint32_t count) const noexcept {
+        return t + static_cast<int64_t>(codel_->interval_ns /
+                                        std::sqrt(static_cast<double>(count)));
+    }
+
+    // Applies AQM to the head of the buffer before an item is handed out,
+    // dropping as many head items as the control law calls for. Senders
+    // are woken for the freed slots; the buffer may end up empty.
+    void shed_locked() {
+        if (!codel_ || is_emtpy()) {
+            return;
+        }
+        Codel& c = *codel_;
+        const int64_t now = control_now_ns();
+        std::size_t dropped = 0;
+        const bool ok = codel_ok_to_drop(now);
+        if (c.dropping) {
+            c.dropping = ok;
+            while (c.dropping && now >= c.drop_next_ns) {
+                take_head_locked();
+                ++dropped;
+                ++c.count;
+                if (is_emtpy() || !codel_ok_to_drop(now)) {
+                    c.dropping = false;
+                } else {
+                    c.drop_next_ns = codel_control_law(c.drop_next_ns, c.count);
+                }
             }
-            const auto pos = send_pos_.load();
-            buffer_[pos] = data;
-            send_pos_.store((pos + 1) % N);
-            spaces_available_.fetch_sub(1);
+        } else if (ok) {
+            take_head_locked();
+            ++dropped;
+            c.dropping = true;
+            // Re-entering soon after the last drop state resumes near the
+            // drop rate it ended with.
+            const uint32_t delta = c.count - c.last_count;
+            c.count = delta > 1 && now - c.drop_next_ns < 16 * c.interval_ns
+                          ? delta
+                          : 1;
+            c.drop_next_ns = codel_control_law(now, c.count);
+            c.last_count = c.count;
+        }
+        if (dropped > 0) {
+            ChannelStats::add(stats_->dropped, dropped);
+            notify_locked(send_cv_, parked_senders_, dropped);
         }
-        receive_cv_.notify_all();
     }
 
-    void send(T&& data) {
-        {
-            std::unique_lock<std::mutex> lk(data_mutex_);
-            send_cv_.wait(lk, [&]() {
-                return !is_full() || closed_.load(std::memory_order_relaxed);
-            });
-            if (closed_.load(std::memory_order_relaxed)) {
-                throw send_after_close("Send data after channel closed");
+    // Waits until `ready` holds, counting the caller in `blocked` for as
+    // long as it is parked. Under WakePolicy::Lifo the caller pushes itself
+    // on `parked` and re-parks on top if someone else got there first.
+    // Blocking waits are offered to ContentionProfiler for sampling.
+    template <class Pred>
+    void wait_counted(CondVar& cv, Waiter*& parked, Lock& lk,
+                      std::atomic<int>& blocked, ContentionKind kind,
+                      Pred ready) {
+        if (ready()) {
+            return;
+        }
+        auto& profiler = ContentionProfiler::instance();
+        bool sampled = profiler.should_sample();
+        const auto start = sampled ? TscClock::now() : TscClock::time_point{};
+        ChannelStats::add(blocked, 1);
+        do {
+            if (wake_policy_ == WakePolicy::Lifo) {
+                while (!ready()) {
+                    Waiter self;
+                    self.below = parked;
+                    parked = &self;
+                    self.cv.wait(lk, [&]() { return self.signaled; });
+                }
+            } else {
+                cv.wait(lk, ready);
             }
-            auto pos = send_pos_.load();
-            buffer_[pos] = std::move(data);
-            send_pos_.store((pos + 1) % N);
-            spaces_available_.fetch_sub(1);
+            if (sampled) {
+                // The stack walk and table probe happen outside the lock so
+                // they do not lengthen the hold times being profiled; the
+                // condition is checked again after relocking.
+                sampled = false;
+                lk.unlock();
+                profiler.record(kind, start);
+                lk.lock();
+            }
+        } while (!ready());
+        ChannelStats::add(blocked, -1);
+    }
+
+    void wait_for_space(Lock& lk) {
+        wait_counted(send_cv_, parked_senders_, lk, stats_->blocked_senders,
+                     ContentionKind::Send, [&]() {
+                         return !is_full() ||
+                                closed_.load(std::memory_order_relaxed);
+                     });
+    }
+
+    void wait_for_data(Lock& lk) {
+        wait_counted(receive_cv_, parked_receivers_, lk,
+                     stats_->blocked_receivers, ContentionKind::Receive,
+                     [&]() { return !is_emtpy() || can_terminate(); });
+    }
+
+    // Releases `lk` and wakes threads parked on one side. Lifo wakes at most
+    // `count` of the most recent waiters; their notification has to happen
+    // before unlocking because a signaled waiter may return (destroying its
+    // Waiter) as soon as it can reacquire the lock.
+    void wake(Lock& lk, CondVar& cv, Waiter*& parked, std::size_t count) {
+        if (wake_policy_ == WakePolicy::Lifo) {
+            notify_locked(cv, parked, count);
+            lk.unlock();
+            return;
         }
-        receive_cv_.notify_all();
+        lk.unlock();
+        cv.notify_all();
     }
 
-    void send(const T& data) {
-        {
-            std::unique_lock<std::mutex> lk(data_mutex_);
-            send_cv_.wait(lk, [&]() { return !is_full() || closed_.load(); });
-            if (closed_.load(std::memory_order_relaxed)) {
-                throw send_after_close("Send data after channel closed");
+    // Same wakeups as wake(), but data_mutex_ stays held.
+    void notify_locked(CondVar& cv, Waiter*& parked, std::size_t count) {
+        if (wake_policy_ == WakePolicy::Lifo) {
+            while (count-- > 0 && parked != nullptr) {
+                Waiter* top = parked;
+                parked = top->below;
+                top->signaled = true;
+                top->cv.notify_one();
             }
-            auto pos = send_pos_.load();
-            buffer_[pos] = data;
-            send_pos_.store((pos + 1) % N);
-            spaces_available_.fetch_sub(1);
+            return;
         }
-        receive_cv_.notify_all();
+        cv.notify_all();
     }
 
+    // Waits for an item that survives AQM. Returns false once the channel
+    // is closed and drained.
+    bool wait_for_item(Lock& lk) {
+        while (true) {
+            wait_for_data(lk);
+            if (can_terminate()) {
+                return false;
+            }
+            shed_locked();
+            if (!is_emtpy()) {
+                return true;
+            }
+        }
+    }
+
+    void wake_receivers(Lock& lk, std::size_t count) {
+        // Lingering receivers always wait on receive_cv_, which Lifo wakeups
+        // otherwise leave alone.
+        if (lingering_ > 0 && wake_policy_ == WakePolicy::Lifo) {
+            receive_cv_.notify_all();
+        }
+        wake(lk, receive_cv_, parked_receivers_, count);
+    }
+
+    void wake_senders(Lock& lk, std::size_t count) {
+        wake(lk, send_cv_, parked_senders_, count);
+    }
+
+    template <class U>
+    void send_one(U&& data) {
+        Lock lk(data_mutex_);
+        wait_for_space(lk);
+        if (closed_.load(std::memory_order_relaxed)) {
+            throw send_after_close("Send data after channel closed");
+        }
+        push_locked(std::forward<U>(data));
+        wake_receivers(lk, 1);
+    }
+
+   public:
+    class send_after_close : public std::runtime_error {
+       public:
+        send_after_close(std::string m) : std::runtime_error(m) {}
+    };
+
+    void send(T& data) { send_one(data); }
+
+    void send(T&& data) { send_one(std::move(data)); }
+
+    void send(const T& data) { send_one(data); }
+
     std::optional<T> receive() {
         std::optional<T> ret;
-        {
-            std::unique_lock<std::mutex> lk(data_mutex_);
-            receive_cv_.wait(lk,
-                             [&]() { return !is_emtpy() || can_terminate(); });
-
-            const int free = spaces_available_.load();
-            const bool closed = closed_.load();
-            if (can_terminate()) {
+        Lock lk(data_mutex_);
+        do {
+            if (!wait_for_item(lk)) {
                 return std::nullopt;
             }
+        } while (throttle(lk, 1) == 0);
 
-            // There is data to read.
-            auto pos = receive_pos_.load();
-            ret.emplace(std::move(buffer_[pos]));
-            receive_pos_.store((pos + 1) % N);
-            spaces_available_.fetch_add(1);
-        }
-        send_cv_.notify_all();
+        // There is data to read.
+        ret.emplace(pop_locked());
+        wake_senders(lk, 1);
         return ret;
     }
 
     void close() noexcept {
-        {
-            std::lock_guard lk(data_mutex_);
-            this->closed_.store(true);
-        }
-        receive_cv_.notify_all();
-        send_cv_.notify_all();
+        Lock lk(data_mutex_);
+        this->closed_.store(true);
+        stats_->closed.store(true, std::memory_order_relaxed);
+        wake_receivers(lk, SIZE_MAX);
+        lk.lock();
+        wake_senders(lk, SIZE_MAX);
     }
 
     SendResult try_send(const T& data) {
@@ -139,13 +655,9 @@ class Channel {
         if (is_full()) {
             return SendResult::Full;
         }
-        const auto pos = send_pos_.load();
-        buffer_[pos] = data;
-        send_pos_.store((pos + 1) % N);
-        spaces_available_.fetch_sub(1);
+        push_locked(data);
 
-        lk.unlock();
-        receive_cv_.notify_all();
+        wake_receivers(lk, 1);
         return SendResult::Success;
     }
 
@@ -157,28 +669,136 @@ class Channel {
         if (is_closed()) {
             return make_pair(RecvResult::Closed, std::optional<T>{});
         }
-        if (is_emtpy()) {
+        shed_locked();
+        if (is_emtpy() || try_throttle(1) == 0) {
             return make_pair(RecvResult::Empty, std::optional<T>{});
         }
-        const auto pos = receive_pos_.load();
-        std::optional<T> result = std::move(buffer_[pos]);
-        receive_pos_.store((pos + 1) % N);
-        spaces_available_.fetch_add(1);
+        std::optional<T> result = pop_locked();
 
-        lk.unlock();
-        send_cv_.notify_all();
+        wake_senders(lk, 1);
         return std::make_pair(RecvResult::Success, result);
     }
 
+    // Sends every item in [first, last), moving from them. Waits whenever the
+    // buffer is full but fills as many slots as possible per lock
+    // acquisition.
+    template <class InputIt>
+    void send_batch(InputIt first, InputIt last) {
+        while (first != last) {
+            Lock lk(data_mutex_);
+            wait_for_space(lk);
+            if (closed_.load(std::memory_order_relaxed)) {
+                throw send_after_close("Send data after channel closed");
+            }
+            std::size_t pushed = 0;
+            while (first != last && !is_full()) {
+                push_locked(std::move(*first));
+                ++first;
+                ++pushed;
+            }
+            wake_receivers(lk, pushed);
+        }
+    }
+
+    // Waits for at least one item, then moves up to `max` items into `out`
+    // under a single lock acquisition (fewer when a rate limit has fewer
+    // tokens due). Returns the number of items taken; zero means the channel
+    // is closed and drained.
+    template <class OutputIt>
+    std::size_t receive_batch(OutputIt out, std::size_t max) {
+        Lock lk(data_mutex_);
+        return take_batch(lk, out, max);
+    }
+
+    // Like receive_batch, but once the first item is in, keeps waiting up
+    // to `linger` for the buffer to hold `max` items, so batches can fill
+    // at low arrival rates at the cost of at most that much extra delay.
+    template <class OutputIt>
+    std::size_t receive_batch_for(OutputIt out, std::size_t max,
+                                  std::chrono::nanoseconds linger) {
+        Lock lk(data_mutex_);
+        if (!wait_for_item(lk) || max == 0) {
+            return 0;
+        }
+        if (linger.count() > 0 && buffered() < max) {
+            const auto deadline = std::chrono::steady_clock::now() +
+                                  std::chrono::duration_cast<
+                                      std::chrono::steady_clock::duration>(
+                                      linger);
+            ++lingering_;
+            while (buffered() < max && !is_closed() &&
+                   receive_cv_.wait_until(lk, deadline) ==
+                       std::cv_status::no_timeout) {
+            }
+            --lingering_;
+        }
+        return take_batch(lk, out, max);
+    }
+
+   private:
+    // Body of receive_batch with data_mutex_ already held.
+    template <class OutputIt>
+    std::size_t take_batch(Lock& lk, OutputIt out, std::size_t max) {
+        std::size_t taken = 0;
+        std::size_t allowed = 0;
+        do {
+            if (!wait_for_item(lk) || max == 0) {
+                return 0;
+            }
+            allowed = throttle(lk, std::min(max, buffered()));
+        } while (allowed == 0);
+        while (taken < allowed && !is_emtpy()) {
+            *out++ = pop_locked();
+            ++taken;
+            shed_locked();
+        }
+        refund_tokens(allowed - taken);
+        if (taken > 0) {
+            wake_senders(lk, taken);
+        }
+        return taken;
+    }
+
+   public:
+    // Moves up to `max` already buffered items into `out` without waiting.
+    // Unlike try_receive, items left in a closed channel are still handed
+    // out.
+    template <class OutputIt>
+    std::size_t try_receive_batch(OutputIt out, std::size_t max) {
+        std::size_t taken = 0;
+        std::unique_lock lk(data_mutex_, std::try_to_lock);
+        if (!lk.owns_lock()) {
+            return 0;
+        }
+        shed_locked();
+        if (is_emtpy()) {
+            return 0;
+        }
+        const std::size_t allowed = try_throttle(std::min(max, buffered()));
+        while (taken < allowed && !is_emtpy()) {
+            *out++ = pop_locked();
+            ++taken;
+            shed_locked();
+        }
+        refund_tokens(allowed - taken);
+        if (taken > 0) {
+            wake_senders(lk, taken);
+        }
+        return taken;
+    }
+
     inline bool is_closed() const noexcept { return closed_.load(); }
 
+    const ChannelStats& stats() const noexcept { return *stats_; }
+    const std::string& name() const noexcept { return stats_->name; }
+
     void operator<<(const T& data) { send(data); }
     void operator<<(T& data) { send(data); }
     void operator<<(T&& data) { send(std::move(data)); }
 };
 
-template <typename T, int N>
-void operator>>(Channel<T, N>& ch, T& data) {
+template <typename T, int N, SlotLayout Layout, class Mutex>
+void operator>>(Channel<T, N, Layout, Mutex>& ch, T& data) {
     ch.receive(data);
 }
 
@@ -192,3 +812,55 @@ int select_nb(Ops&&... ops) {
         if (v[i]()) return static_cast<int>(i);
     return -1;  // default
 }
+
+// A select_drain case: a channel and the handler its items go to.
+template <class Ch, class Fn>
+struct DrainCase {
+    Ch& channel;
+    Fn handler;
+
+    // Moves up to `k` buffered items out with one try_receive_batch and
+    // feeds them to the handler one by one.
+    std::size_t drain(std::size_t k) {
+        using Item = typename Ch::value_type;
+        // Reused between calls; taken out first so a handler may itself
+        // call select_drain.
+        thread_local std::vector<Item> spare;
+        std::vector<Item> batch;
+        batch.swap(spare);
+        batch.clear();
+        const std::size_t taken =
+            channel.try_receive_batch(std::back_inserter(batch), k);
+        for (auto& item : batch) {
+            handler(std::move(item));
+        }
+        batch.clear();
+        spare.swap(batch);
+        return taken;
+    }
+};
+
+template <class Ch, class Fn>
+DrainCase<Ch, std::decay_t<Fn>> drain_case(Ch& channel, Fn&& handler) {
+    return {channel, std::forward<Fn>(handler)};
+}
+
+// Non-blocking multi-channel drain. In one pass over the cases, takes up
+// to `k` items from every channel that has some (one lock acquisition
+// each) and calls that case's handler with each item. The starting case
+// rotates from call to call so no channel is always served first. Returns
+// the number of items handled; zero when nothing was ready.
+template <class... Cases>
+std::size_t select_drain(std::size_t k, Cases&&... cases) {
+    constexpr std::size_t n = sizeof...(Cases);
+    static_assert(n > 0, "select_drain needs at least one case");
+    thread_local std::size_t start = 0;
+    const std::size_t first = start++ % n;
+    std::size_t taken = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::size_t index = (first + i) % n;
+        std::size_t position = 0;
+        ((position++ == index ? (taken += cases.drain(k)) : 0), ...);
+    }
+    return taken;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Counters a channel keeps about itself. Channels update them while holding
+// their own lock, so writers never race; readers (exporters) may load them
+// at any time and see a slightly stale but consistent-per-field view.
+struct ChannelStats {
+    struct Snapshot {
+        std::string name;
+        std::size_t capacity{0};
+        int64_t occupancy{0};
+        uint64_t sent{0};
+        uint64_t received{0};
+        int blocked_senders{0};
+        int blocked_receivers{0};
+        uint64_t throttled_ns{0};
+        uint64_t dropped{0};
+        uint64_t order_switches{0};
+        bool closed{false};
+    };
+
+    ChannelStats(std::string channel_name, std::size_t channel_capacity)
+        : name(std::move(channel_name)), capacity(channel_capacity) {}
+
+    const std::string name;
+    const std::size_t capacity;
+    std::atomic<int64_t> occupancy{0};
+    std::atomic<uint64_t> sent{0};
+    std::atomic<uint64_t> received{0};
+    std::atomic<int> blocked_senders{0};
+    std::atomic<int> blocked_receivers{0};
+    // Time receivers spent waiting for a rate-limit token.
+    std::atomic<uint64_t> throttled_ns{0};
+    // Items discarded by active queue management.
+    std::atomic<uint64_t> dropped{0};
+    // Adaptive ordering switches between FIFO and LIFO, both directions.
+    std::atomic<uint64_t> order_switches{0};
+    std::atomic<bool> closed{false};
+
+    Snapshot snapshot() const {
+        Snapshot s;
+        s.name = name;
+        s.capacity = capacity;
+        s.occupancy = occupancy.load(std::memory_order_relaxed);
+        s.sent = sent.load(std::memory_order_relaxed);
+        s.received = received.load(std::memory_order_relaxed);
+        s.blocked_senders = blocked_senders.load(std::memory_order_relaxed);
+        s.blocked_receivers =
+            blocked_receivers.load(std::memory_order_relaxed);
+        s.throttled_ns = throttled_ns.load(std::memory_order_relaxed);
+        s.dropped = dropped.load(std::memory_order_relaxed);
+        s.order_switches = order_switches.load(std::memory_order_relaxed);
+        s.closed = closed.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    // Single-writer update: only valid while the owning channel's lock is
+    // held, which saves a locked read-modify-write on the hot path.
+    template <class Int, class Delta>
+    static void add(std::atomic<Int>& counter, Delta delta) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) +
+                          static_cast<Int>(delta),
+                      std::memory_order_relaxed);
+    }
+};
+
+// Process-wide list of named channels. Channels constructed with a name join
+// it and leave on destruction. Membership changes copy the list and then
+// swap in the new version; a small mutex guards only that pointer, so taking
+// a snapshot costs one short lock and a reference count bump, and iterating
+// it never blocks (or is blocked by) channels coming and going. Entries hold
+// the stats by shared_ptr, so a snapshot stays readable after its channel
+// is destroyed.
+class ChannelRegistry {
+   public:
+    using Entries = std::vector<std::shared_ptr<const ChannelStats>>;
+
+    static ChannelRegistry& instance() {
+        // Leaked on purpose: channels with static storage may leave after
+        // function-local statics have been destroyed.
+        static ChannelRegistry* registry = new ChannelRegistry();
+        return *registry;
+    }
+
+    ChannelRegistry() : entries_(std::make_shared<const Entries>()) {}
+    ChannelRegistry(const ChannelRegistry&) = delete;
+    ChannelRegistry& operator=(const ChannelRegistry&) = delete;
+
+    void join(std::shared_ptr<const ChannelStats> stats) {
+        std::lock_guard<std::mutex> lk(write_mutex_);
+        auto next = std::make_shared<Entries>(*snapshot());
+        next->push_back(std::move(stats));
+        publish(std::move(next));
+    }
+
+    void leave(const ChannelStats* stats) {
+        std::lock_guard<std::mutex> lk(write_mutex_);
+        auto next = std::make_shared<Entries>(*snapshot());
+        next->erase(std::remove_if(next->begin(), next->end(),
+                                   [&](const auto& e) {
+                                       return e.get() == stats;
+                                   }),
+                    next->end());
+        publish(std::move(next));
+    }
+
+    std::shared_ptr<const Entries> snapshot() const {
+        std::lock_guard<std::mutex> lk(pointer_mutex_);
+        return entries_;
+    }
+
+   private:
+    // The replaced list is released after the lock, when `next` goes away.
+    void publish(std::shared_ptr<const Entries> next) {
+        std::lock_guard<std::mutex> lk(pointer_mutex_);
+        entries_.swap(next);
+    }
+
+    // Serializes membership changes.
+    std::mutex write_mutex_;
+    mutable std::mutex pointer_mutex_;
+    std::shared_ptr<const Entries> entries_;
+};
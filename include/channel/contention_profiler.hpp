@@ -0,0 +1,246 @@
+#pragma once
+
+#include <dlfcn.h>
+#include <execinfo.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <channel/tsc_clock.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Which side of a channel a blocked thread was waiting on.
+enum class ContentionKind { Send, Receive };
+
+// Sampling profiler for blocking waits. When enabled, a sampled blocked send
+// or receive records a short call stack together with how long it waited.
+// Samples are aggregated per (stack, kind) in a fixed-size lock-free hash
+// table, so recording never takes a lock and never allocates.
+//
+// Only waits that actually block reach the profiler, and a disabled
+// profiler costs one relaxed load on that path; uncontended operations are
+// never touched. Because Channel's entry points are inlined, the first
+// frame above the recording hook usually lands in the function that called
+// send/receive, which is the call site the report is about.
+class ContentionProfiler {
+   public:
+    static constexpr std::size_t kStackDepth = 4;
+
+    struct Site {
+        ContentionKind kind;
+        std::vector<void*> frames;
+        uint64_t waits;
+        uint64_t total_ns;
+        uint64_t max_ns;
+    };
+
+    static ContentionProfiler& instance() {
+        // Leaked on purpose so channels destroyed during static destruction
+        // can still reach it.
+        static ContentionProfiler* profiler = new ContentionProfiler();
+        return *profiler;
+    }
+
+    // Starts recording one of every `sample_period` blocked waits per
+    // thread.
+    void enable(uint32_t sample_period = 1) {
+        // The first backtrace() may load the unwinder and allocate; do that
+        // here rather than inside a wait.
+        void* warmup[1];
+        ::backtrace(warmup, 1);
+        TscClock::calibrate();
+        period_.store(std::max<uint32_t>(sample_period, 1),
+                      std::memory_order_relaxed);
+        enabled_.store(true, std::memory_order_release);
+    }
+
+    void disable() noexcept {
+        enabled_.store(false, std::memory_order_release);
+    }
+
+    bool enabled() const noexcept {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    // Decides whether the wait about to start is sampled.
+    bool should_sample() noexcept {
+        if (!enabled_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        thread_local uint32_t countdown = 0;
+        if (countdown == 0) {
+            countdown = period_.load(std::memory_order_relaxed);
+        }
+        return --countdown == 0;
+    }
+
+    // Records a wait that started at `start` (a TscClock reading) and has
+    // just ended. Kept out of line so its own frame is the one skipped in
+    // the captured stack.
+    __attribute__((noinline)) void record(ContentionKind kind,
+                                          TscClock::time_point start) {
+        const auto waited = TscClock::now() - start;
+        void* raw[kStackDepth + 1];
+        const int captured = ::backtrace(raw, kStackDepth + 1);
+        const std::size_t depth = captured > 1 ? captured - 1 : 0;
+        add(kind, raw + 1, depth,
+            static_cast<uint64_t>(std::max<int64_t>(waited.count(), 0)));
+    }
+
+    // Call sites ordered by total time spent waiting, longest first.
+    std::vector<Site> top(std::size_t n) const {
+        std::vector<Site> sites;
+        for (const auto& bucket : buckets_) {
+            if (!bucket.ready.load(std::memory_order_acquire)) {
+                continue;
+            }
+            sites.push_back(Site{
+                bucket.kind,
+                std::vector<void*>(bucket.frames.begin(),
+                                   bucket.frames.begin() + bucket.depth),
+                bucket.waits.load(std::memory_order_relaxed),
+                bucket.total_ns.load(std::memory_order_relaxed),
+                bucket.max_ns.load(std::memory_order_relaxed)});
+        }
+        const std::size_t keep = std::min(n, sites.size());
+        std::partial_sort(sites.begin(), sites.begin() + keep, sites.end(),
+                          [](const Site& a, const Site& b) {
+                              return a.total_ns > b.total_ns;
+                          });
+        sites.resize(keep);
+        return sites;
+    }
+
+    // Writes the top `n` call sites with symbolized stacks. Every frame line
+    // ends with "module +0xoffset", which `addr2line -f -C -i -e module
+    // 0xoffset` resolves to a source line (build with -g). Function names
+    // for the main executable need -rdynamic.
+    void report(std::ostream& out, std::size_t n = 10) const {
+        const auto sites = top(n);
+        out << "Contention profile: top " << sites.size() << " call sites";
+        const uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+        if (dropped > 0) {
+            out << " (" << dropped << " samples dropped, table full)";
+        }
+        out << '\n';
+        for (std::size_t i = 0; i < sites.size(); ++i) {
+            const Site& site = sites[i];
+            out << '#' << i + 1 << ' '
+                << (site.kind == ContentionKind::Send ? "send" : "receive")
+                << " waits=" << site.waits << " total_ms=" << std::fixed
+                << std::setprecision(3) << site.total_ns / 1e6
+                << " max_ms=" << site.max_ns / 1e6 << '\n';
+            char** names = ::backtrace_symbols(
+                site.frames.data(), static_cast<int>(site.frames.size()));
+            for (std::size_t f = 0; f < site.frames.size(); ++f) {
+                out << "    " << (names != nullptr ? names[f] : "?") << ' '
+                    << module_offset(site.frames[f]) << '\n';
+            }
+            std::free(names);
+        }
+    }
+
+    // Forgets every sample. Only call while no thread can be recording,
+    // e.g. after disable() with channels quiescent.
+    void reset() noexcept {
+        for (auto& bucket : buckets_) {
+            bucket.ready.store(false, std::memory_order_relaxed);
+            bucket.key.store(0, std::memory_order_relaxed);
+            bucket.waits.store(0, std::memory_order_relaxed);
+            bucket.total_ns.store(0, std::memory_order_relaxed);
+            bucket.max_ns.store(0, std::memory_order_relaxed);
+        }
+        dropped_.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t dropped() const noexcept {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    static constexpr std::size_t kBuckets = 1024;
+    static constexpr std::size_t kMaxProbe = 32;
+
+    struct Bucket {
+        // Hash of kind and frames; zero marks a free bucket. The winner of
+        // the claim fills in the rest and then sets `ready`.
+        std::atomic<uint64_t> key{0};
+        std::atomic<bool> ready{false};
+        ContentionKind kind{ContentionKind::Send};
+        std::array<void*, kStackDepth> frames{};
+        std::size_t depth{0};
+        std::atomic<uint64_t> waits{0};
+        std::atomic<uint64_t> total_ns{0};
+        std::atomic<uint64_t> max_ns{0};
+    };
+
+    ContentionProfiler() = default;
+
+    static uint64_t hash(ContentionKind kind, void* const* frames,
+                         std::size_t depth) noexcept {
+        // FNV-1a over the frame addresses.
+        uint64_t h = 1469598103934665603ull ^ static_cast<uint64_t>(kind);
+        for (std::size_t i = 0; i < depth; ++i) {
+            h = (h ^ reinterpret_cast<uintptr_t>(frames[i])) *
+                1099511628211ull;
+        }
+        return h == 0 ? 1 : h;
+    }
+
+    void add(ContentionKind kind, void* const* frames, std::size_t depth,
+             uint64_t waited_ns) noexcept {
+        const uint64_t key = hash(kind, frames, depth);
+        for (std::size_t probe = 0; probe < kMaxProbe; ++probe) {
+            Bucket& bucket = buckets_[(key + probe) % kBuckets];
+            uint64_t current = bucket.key.load(std::memory_order_acquire);
+            if (current == 0) {
+                if (bucket.key.compare_exchange_strong(
+                        current, key, std::memory_order_acq_rel)) {
+                    bucket.kind = kind;
+                    bucket.depth = depth;
+                    std::copy(frames, frames + depth, bucket.frames.begin());
+                    bucket.ready.store(true, std::memory_order_release);
+                }
+            }
+            if (current != 0 && current != key) {
+                continue;
+            }
+            bucket.waits.fetch_add(1, std::memory_order_relaxed);
+            bucket.total_ns.fetch_add(waited_ns, std::memory_order_relaxed);
+            uint64_t max = bucket.max_ns.load(std::memory_order_relaxed);
+            while (waited_ns > max &&
+                   !bucket.max_ns.compare_exchange_weak(
+                       max, waited_ns, std::memory_order_relaxed)) {
+            }
+            return;
+        }
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static std::string module_offset(const void* address) {
+        Dl_info info;
+        if (::dladdr(address, &info) == 0 || info.dli_fname == nullptr) {
+            return "?";
+        }
+        // Return addresses point after the call; step back into it so
+        // addr2line reports the calling line.
+        const auto offset = reinterpret_cast<uintptr_t>(address) -
+                            reinterpret_cast<uintptr_t>(info.dli_fbase) - 1;
+        std::ostringstream text;
+        text << info.dli_fname << " +0x" << std::hex << offset;
+        return text.str();
+    }
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<uint32_t> period_{1};
+    std::atomic<uint64_t> dropped_{0};
+    std::array<Bucket, kBuckets> buckets_{};
+};
@@ -0,0 +1,334 @@
+#pragma once
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <atomic>
+#include <channel/spsc_queue.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+struct CoreRuntimeOptions {
+    // Worker count; 0 means one per CPU the process may run on.
+    std::size_t cores{0};
+    // Pin worker i to the i-th allowed CPU (wrapping around).
+    bool pin{true};
+    // Capacity of every link in the mesh and of each external inbox. A link
+    // is allocated by its first submit_to() and holds link_capacity tasks of
+    // sizeof(std::function<void()>) (32 bytes with libstdc++), so a full
+    // mesh of N cores costs N * (N + 1) * link_capacity * 32 bytes: 136MB
+    // at 64 cores with the default.
+    std::size_t link_capacity{1024};
+    // Most tasks taken from one link before moving to the next.
+    std::size_t poll_batch{64};
+    // Empty polling rounds before a worker parks.
+    int spin_polls{256};
+};
+
+// Thread-per-core, shared-nothing task runtime. Each worker owns one core
+// and an inbound SPSC link from every other worker, so the cores form an
+// N x N mesh with no shared queue: a task sent from core a to core b only
+// ever touches the a->b link. Links are only allocated once something is
+// sent over them, so a runtime whose cores talk to a few neighbours pays
+// for those links rather than the whole mesh. Threads outside the runtime
+// submit through a per-core inbox, which is the one place producers are
+// serialized (by a mutex, since external submission is the slow path).
+//
+// Workers sweep their links round-robin, running up to poll_batch tasks per
+// link and rotating the starting link each sweep so no sender starves. An
+// idle worker spins for a while and then parks until someone submits to it.
+//
+// Tasks must not throw; like an exception escaping std::thread, one
+// escaping a task terminates the process.
+class CoreRuntime {
+   public:
+    using Task = std::function<void()>;
+
+    explicit CoreRuntime(CoreRuntimeOptions options = {}) : options_(options) {
+        const std::vector<int> cpus = allowed_cpus();
+        if (options_.cores == 0) {
+            options_.cores = cpus.empty() ? 1 : cpus.size();
+        }
+        if (options_.poll_batch == 0 || options_.link_capacity == 0) {
+            throw std::invalid_argument("CoreRuntime needs batch and capacity");
+        }
+        const std::size_t n = options_.cores;
+        for (std::size_t c = 0; c < n; ++c) {
+            // Links 0..n-1 come from workers, link n is the external inbox.
+            cores_.push_back(std::make_unique<Core>(n + 1));
+        }
+        for (std::size_t c = 0; c < n; ++c) {
+            const int cpu = options_.pin && !cpus.empty()
+                                ? cpus[c % cpus.size()]
+                                : -1;
+            cores_[c]->thread = std::thread([this, c, cpu]() { run(c, cpu); });
+        }
+    }
+
+    ~CoreRuntime() { stop(); }
+
+    CoreRuntime(const CoreRuntime&) = delete;
+    CoreRuntime& operator=(const CoreRuntime&) = delete;
+
+    std::size_t cores() const noexcept { return cores_.size(); }
+
+    // Links allocated so far, external inboxes included.
+    std::size_t links() const noexcept {
+        std::size_t total = 0;
+        for (const auto& core : cores_) {
+            for (const auto& link : core->incoming) {
+                if (link.queue.load(std::memory_order_acquire)) ++total;
+            }
+        }
+        return total;
+    }
+
+    // Index of the calling worker, or -1 outside any CoreRuntime worker.
+    static int current_core() noexcept { return self().core; }
+
+    // Queues `task` to run on `core`. From a worker this uses the direct
+    // link; if that link is full the worker keeps running its own tasks
+    // until there is room, so two cores flooding each other cannot
+    // deadlock.
+    void submit_to(std::size_t core, Task task) {
+        if (core >= cores_.size()) {
+            throw std::out_of_range("No such core");
+        }
+        if (stopping_.load(std::memory_order_relaxed)) {
+            throw std::logic_error("CoreRuntime is stopped");
+        }
+        Core& target = *cores_[core];
+        const Self& me = self();
+        if (me.runtime == this) {
+            SpscQueue<Task>& link = outgoing(target, me.core);
+            while (!link.try_push(std::move(task))) {
+                if (poll(static_cast<std::size_t>(me.core)) == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        } else {
+            std::lock_guard<std::mutex> lk(target.inbox_mutex);
+            SpscQueue<Task>& inbox =
+                outgoing(target, target.incoming.size() - 1);
+            while (!inbox.try_push(std::move(task))) {
+                std::this_thread::yield();
+            }
+        }
+        wake(target);
+    }
+
+    // Returns once no task is queued or running anywhere. Only meaningful
+    // while no thread outside the runtime is submitting.
+    void wait_idle() const {
+        while (!quiescent()) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Runs everything already submitted (including the tasks it spawns) to
+    // completion, then stops and joins the workers. Idempotent.
+    void stop() {
+        if (stopping_.load() || cores_.empty()) {
+            return;
+        }
+        wait_idle();
+        stopping_.store(true, std::memory_order_seq_cst);
+        for (auto& core : cores_) {
+            {
+                std::lock_guard<std::mutex> lk(core->park_mutex);
+                core->sleeping.store(false, std::memory_order_relaxed);
+            }
+            core->park_cv.notify_one();
+        }
+        for (auto& core : cores_) {
+            core->thread.join();
+        }
+    }
+
+   private:
+    // Written once, by the link's only producer; null until first used.
+    struct Link {
+        std::atomic<SpscQueue<Task>*> queue{nullptr};
+
+        ~Link() { delete queue.load(std::memory_order_relaxed); }
+    };
+
+    struct Core {
+        explicit Core(std::size_t sources) : incoming(sources) {}
+
+        std::vector<Link> incoming;
+        std::mutex inbox_mutex;
+        // Set while the worker may be popping or running tasks.
+        alignas(64) std::atomic<bool> busy{true};
+        std::atomic<bool> sleeping{false};
+        std::mutex park_mutex;
+        std::condition_variable park_cv;
+        std::thread thread;
+    };
+
+    struct Self {
+        const CoreRuntime* runtime{nullptr};
+        int core{-1};
+    };
+
+    static Self& self() noexcept {
+        thread_local Self me;
+        return me;
+    }
+
+    static std::vector<int> allowed_cpus() {
+        std::vector<int> cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (::sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    // The link from `from` into `target`, allocated on first use. Only its
+    // producer gets here (worker `from`, or an external thread holding the
+    // inbox mutex), so no two threads can race to create it.
+    SpscQueue<Task>& outgoing(Core& target, std::size_t from) {
+        Link& link = target.incoming[from];
+        SpscQueue<Task>* queue = link.queue.load(std::memory_order_relaxed);
+        if (queue == nullptr) {
+            queue = new SpscQueue<Task>(options_.link_capacity);
+            link.queue.store(queue, std::memory_order_release);
+        }
+        return *queue;
+    }
+
+    // One sweep over every inbound link of `core`, starting from a
+    // rotating position. Returns the number of tasks run.
+    std::size_t poll(std::size_t core) {
+        Core& me = *cores_[core];
+        const std::size_t sources = me.incoming.size();
+        std::size_t& start = sweep_start();
+        std::size_t ran = 0;
+        for (std::size_t i = 0; i < sources; ++i) {
+            SpscQueue<Task>* link = me.incoming[(start + i) % sources]
+                                        .queue.load(std::memory_order_acquire);
+            if (link == nullptr) continue;
+            ran += link->pop_batch([](Task&& task) { task(); },
+                                   options_.poll_batch);
+        }
+        start = (start + 1) % sources;
+        return ran;
+    }
+
+    static std::size_t& sweep_start() noexcept {
+        thread_local std::size_t start = 0;
+        return start;
+    }
+
+    bool has_work(const Core& core) const noexcept {
+        for (const auto& link : core.incoming) {
+            const SpscQueue<Task>* queue =
+                link.queue.load(std::memory_order_acquire);
+            if (queue && !queue->empty()) return true;
+        }
+        return false;
+    }
+
+    void run(std::size_t core, int cpu) {
+        self() = Self{this, static_cast<int>(core)};
+        if (cpu >= 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            // Best effort: a restricted container may refuse.
+            ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+        }
+        Core& me = *cores_[core];
+        while (true) {
+            if (poll(core) > 0) {
+                continue;
+            }
+            me.busy.store(false, std::memory_order_seq_cst);
+            if (!idle(me)) {
+                return;
+            }
+            // Raised before the next pop so wait_idle() can never see an
+            // idle worker that is about to run something.
+            me.busy.store(true, std::memory_order_seq_cst);
+        }
+    }
+
+    // Spins, then parks, until `me` has work (true) or the runtime stops
+    // (false).
+    bool idle(Core& me) {
+        for (int spin = 0;; ++spin) {
+            if (has_work(me)) return true;
+            if (stopping_.load(std::memory_order_acquire)) return false;
+            if (spin < options_.spin_polls) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::unique_lock<std::mutex> lk(me.park_mutex);
+            me.sleeping.store(true, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (has_work(me) || stopping_.load()) {
+                me.sleeping.store(false, std::memory_order_relaxed);
+                continue;
+            }
+            me.park_cv.wait(lk, [&]() {
+                return !me.sleeping.load(std::memory_order_relaxed);
+            });
+            spin = 0;
+        }
+    }
+
+    // Pairs with the fence in idle(): either the submitter sees the target
+    // asleep, or the target sees the new task before parking.
+    void wake(Core& target) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!target.sleeping.load(std::memory_order_relaxed)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lk(target.park_mutex);
+            target.sleeping.store(false, std::memory_order_relaxed);
+        }
+        target.park_cv.notify_one();
+    }
+
+    uint64_t total_popped() const noexcept {
+        uint64_t total = 0;
+        for (const auto& core : cores_) {
+            for (const auto& link : core->incoming) {
+                const SpscQueue<Task>* queue =
+                    link.queue.load(std::memory_order_acquire);
+                if (queue) total += queue->popped();
+            }
+        }
+        return total;
+    }
+
+    // Workers only pop while busy, so if every worker looked idle, every
+    // link looked empty and no pop happened in between (the pop count did
+    // not move), nothing was running and nothing is left to run.
+    bool quiescent() const {
+        const uint64_t before = total_popped();
+        for (const auto& core : cores_) {
+            if (core->busy.load(std::memory_order_seq_cst)) return false;
+        }
+        for (const auto& core : cores_) {
+            if (has_work(*core)) return false;
+        }
+        return total_popped() == before;
+    }
+
+    CoreRuntimeOptions options_;
+    std::vector<std::unique_ptr<Core>> cores_;
+    std::atomic<bool> stopping_{false};
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+// Memory resource that forwards to an upstream resource and counts what
+// passes through it. Give each channel (or each tenant's channels) its own
+// CountingResource to see how much memory they take and how often they hit
+// the allocator; wrap an arena or pool to keep that traffic off the global
+// heap.
+class CountingResource : public std::pmr::memory_resource {
+   public:
+    explicit CountingResource(
+        std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : upstream_(upstream) {}
+
+    CountingResource(const CountingResource&) = delete;
+    CountingResource& operator=(const CountingResource&) = delete;
+
+    std::pmr::memory_resource* upstream() const noexcept { return upstream_; }
+
+    uint64_t allocations() const noexcept {
+        return allocations_.load(std::memory_order_relaxed);
+    }
+    uint64_t deallocations() const noexcept {
+        return deallocations_.load(std::memory_order_relaxed);
+    }
+    // Total bytes ever handed out.
+    uint64_t bytes_allocated() const noexcept {
+        return bytes_allocated_.load(std::memory_order_relaxed);
+    }
+    uint64_t bytes_in_use() const noexcept {
+        return bytes_in_use_.load(std::memory_order_relaxed);
+    }
+    uint64_t peak_bytes() const noexcept {
+        return peak_bytes_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        void* p = upstream_->allocate(bytes, alignment);
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
+        const uint64_t in_use =
+            bytes_in_use_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        uint64_t peak = peak_bytes_.load(std::memory_order_relaxed);
+        while (in_use > peak &&
+               !peak_bytes_.compare_exchange_weak(peak, in_use,
+                                                  std::memory_order_relaxed)) {
+        }
+        return p;
+    }
+
+    void do_deallocate(void* p, std::size_t bytes,
+                       std::size_t alignment) override {
+        upstream_->deallocate(p, bytes, alignment);
+        deallocations_.fetch_add(1, std::memory_order_relaxed);
+        bytes_in_use_.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* const upstream_;
+    std::atomic<uint64_t> allocations_{0};
+    std::atomic<uint64_t> deallocations_{0};
+    std::atomic<uint64_t> bytes_allocated_{0};
+    std::atomic<uint64_t> bytes_in_use_{0};
+    std::atomic<uint64_t> peak_bytes_{0};
+};
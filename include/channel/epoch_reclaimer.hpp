@@ -0,0 +1,204 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+// Epoch-based reclamation for lock-free structures. Threads pin the domain
+// while they may hold raw pointers into shared nodes; unlinked nodes are
+// retired instead of freed and only handed to their deleter once every
+// thread that could still see them has unpinned (two epoch advances later).
+//
+// There is one process-wide domain. Per-thread records are recycled when
+// threads exit, and anything a thread still had pending is adopted by the
+// domain and freed by whichever thread collects next.
+class EpochDomain {
+   public:
+    using Deleter = void (*)(void*);
+
+    static EpochDomain& instance() {
+        // Leaked on purpose: thread-exit handlers can run after statics are
+        // destroyed and still need the domain.
+        static EpochDomain* domain = new EpochDomain();
+        return *domain;
+    }
+
+    // RAII pin. Pins nest, so structures can pin internally without caring
+    // whether the caller already did.
+    class Guard {
+       public:
+        explicit Guard(EpochDomain& domain) : domain_(domain) {
+            domain_.enter();
+        }
+        ~Guard() { domain_.exit(); }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+       private:
+        EpochDomain& domain_;
+    };
+
+    Guard pin() { return Guard(*this); }
+
+    // Defers deleter(ptr) until no pinned thread can reach ptr. The object
+    // must already be unlinked from every shared structure.
+    void retire(void* ptr, Deleter deleter) {
+        ThreadState& state = local();
+        state.pending.push_back(
+            Retired{ptr, deleter, epoch_.load(std::memory_order_seq_cst)});
+        if (state.pending.size() >= kCollectThreshold) {
+            collect(state);
+        }
+    }
+
+    // Advances the epoch if possible and frees what has become safe on the
+    // calling thread (plus orphans left by exited threads).
+    void collect() { collect(local()); }
+
+    uint64_t reclaimed() const noexcept {
+        return reclaimed_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    static constexpr uint64_t kIdle = std::numeric_limits<uint64_t>::max();
+    static constexpr std::size_t kCollectThreshold = 64;
+
+    struct Record {
+        alignas(64) std::atomic<uint64_t> epoch{kIdle};
+        std::atomic<bool> in_use{false};
+        Record* next{nullptr};
+    };
+
+    struct Retired {
+        void* ptr;
+        Deleter deleter;
+        uint64_t epoch;
+    };
+
+    struct ThreadState {
+        EpochDomain* domain{nullptr};
+        Record* record{nullptr};
+        int nesting{0};
+        std::vector<Retired> pending;
+
+        ~ThreadState() {
+            if (domain != nullptr) {
+                domain->release(*this);
+            }
+        }
+    };
+
+    EpochDomain() = default;
+
+    ThreadState& local() {
+        thread_local ThreadState state;
+        if (state.record == nullptr) {
+            state.domain = this;
+            state.record = acquire_record();
+        }
+        return state;
+    }
+
+    Record* acquire_record() {
+        for (Record* r = records_.load(std::memory_order_acquire); r != nullptr;
+             r = r->next) {
+            bool expected = false;
+            if (r->in_use.compare_exchange_strong(expected, true)) {
+                return r;
+            }
+        }
+        Record* fresh = new Record();
+        fresh->in_use.store(true, std::memory_order_relaxed);
+        Record* head = records_.load(std::memory_order_relaxed);
+        do {
+            fresh->next = head;
+        } while (!records_.compare_exchange_weak(head, fresh,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed));
+        return fresh;
+    }
+
+    void enter() {
+        ThreadState& state = local();
+        if (state.nesting++ == 0) {
+            state.record->epoch.store(epoch_.load(std::memory_order_seq_cst),
+                                      std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    void exit() {
+        ThreadState& state = local();
+        if (--state.nesting == 0) {
+            state.record->epoch.store(kIdle, std::memory_order_release);
+        }
+    }
+
+    // The epoch only moves once every pinned thread has observed it.
+    void try_advance() {
+        uint64_t current = epoch_.load(std::memory_order_seq_cst);
+        for (Record* r = records_.load(std::memory_order_acquire); r != nullptr;
+             r = r->next) {
+            const uint64_t e = r->epoch.load(std::memory_order_seq_cst);
+            if (e != kIdle && e != current) {
+                return;
+            }
+        }
+        epoch_.compare_exchange_strong(current, current + 1,
+                                       std::memory_order_seq_cst);
+    }
+
+    std::size_t free_safe(std::vector<Retired>& list, uint64_t epoch) {
+        std::size_t freed = 0;
+        auto keep = list.begin();
+        for (auto it = list.begin(); it != list.end(); ++it) {
+            if (it->epoch + 2 <= epoch) {
+                it->deleter(it->ptr);
+                ++freed;
+            } else {
+                *keep++ = *it;
+            }
+        }
+        list.erase(keep, list.end());
+        return freed;
+    }
+
+    void collect(ThreadState& state) {
+        try_advance();
+        const uint64_t epoch = epoch_.load(std::memory_order_seq_cst);
+        std::size_t freed = free_safe(state.pending, epoch);
+        if (has_orphans_.load(std::memory_order_relaxed)) {
+            std::unique_lock<std::mutex> lk(orphans_mutex_, std::try_to_lock);
+            if (lk.owns_lock()) {
+                freed += free_safe(orphans_, epoch);
+                has_orphans_.store(!orphans_.empty(),
+                                   std::memory_order_relaxed);
+            }
+        }
+        reclaimed_.fetch_add(freed, std::memory_order_relaxed);
+    }
+
+    void release(ThreadState& state) {
+        if (!state.pending.empty()) {
+            std::lock_guard<std::mutex> lk(orphans_mutex_);
+            orphans_.insert(orphans_.end(), state.pending.begin(),
+                            state.pending.end());
+            has_orphans_.store(true, std::memory_order_relaxed);
+            state.pending.clear();
+        }
+        state.record->epoch.store(kIdle, std::memory_order_release);
+        state.record->in_use.store(false, std::memory_order_release);
+        state.record = nullptr;
+    }
+
+    alignas(64) std::atomic<uint64_t> epoch_{0};
+    std::atomic<Record*> records_{nullptr};
+    std::atomic<uint64_t> reclaimed_{0};
+
+    std::mutex orphans_mutex_;
+    std::vector<Retired> orphans_;
+    std::atomic<bool> has_orphans_{false};
+};
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <channel/channel.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+struct FairSchedulerOptions {
+    // Items a weight-1 tenant may take per round; a tenant of weight w gets
+    // w times as many.
+    std::size_t quantum{16};
+};
+
+// Deficit round robin over a fixed set of tenant channels. Every tenant owns
+// a Channel<T, N>; producers send through the scheduler so it can track
+// which tenants have work. Only those sit in the active list, and each turn
+// serves the tenant at its head, so picking the next tenant costs O(1) no
+// matter how many tenants are idle, and a noisy tenant gets at most its
+// weighted share of a round before everyone else with work has had theirs.
+//
+// Tenants register as active with one atomic exchange on their first item
+// after going idle; sending to an already active tenant never touches the
+// scheduler's lock.
+template <typename T, int N = 64>
+class FairScheduler {
+   public:
+    using Tenant = std::size_t;
+
+    // What one receive_batch() call served.
+    struct Turn {
+        Tenant tenant{0};
+        // Zero only once the scheduler is closed and every tenant drained.
+        std::size_t count{0};
+    };
+
+    explicit FairScheduler(const std::vector<std::size_t>& weights,
+                           FairSchedulerOptions options = {})
+        : options_(options) {
+        if (weights.empty() || options_.quantum == 0) {
+            throw std::invalid_argument("FairScheduler needs tenants");
+        }
+        for (std::size_t weight : weights) {
+            if (weight == 0) {
+                throw std::invalid_argument("Tenant weight must be positive");
+            }
+            tenants_.push_back(std::make_unique<State>(weight));
+        }
+    }
+
+    FairScheduler(const FairScheduler&) = delete;
+    FairScheduler& operator=(const FairScheduler&) = delete;
+
+    std::size_t tenants() const noexcept { return tenants_.size(); }
+
+    // Blocks while the tenant's channel is full. Throws
+    // Channel::send_after_close once the scheduler is closed.
+    void send(Tenant tenant, T value) {
+        State& state = *tenants_.at(tenant);
+        state.channel.send(std::move(value));
+        activate(tenant, state);
+    }
+
+    // Waits until some tenant has work, then moves up to `max` of that
+    // tenant's items into `out` under one channel lock. A tenant keeps being
+    // served by successive calls until it has used its deficit or run dry,
+    // and then goes to the back of the round. Throws std::invalid_argument
+    // for max == 0, since an empty Turn already means closed and drained.
+    template <class OutputIt>
+    Turn receive_batch(OutputIt out, std::size_t max) {
+        if (max == 0) {
+            throw std::invalid_argument("receive_batch needs max > 0");
+        }
+        std::unique_lock<std::mutex> lk(mutex_);
+        while (true) {
+            cv_.wait(lk, [&]() {
+                return !active_.empty() || (closed_ && in_service_ == 0);
+            });
+            if (active_.empty()) {
+                return Turn{0, 0};
+            }
+            const Tenant tenant = active_.front();
+            active_.pop_front();
+            State& state = *tenants_[tenant];
+            if (state.fresh) {
+                state.deficit += options_.quantum * state.weight;
+                state.fresh = false;
+            }
+            ++in_service_;
+            lk.unlock();
+
+            // Only the thread serving a tenant takes from its channel, so
+            // what occupancy shows is there and receive_batch cannot block.
+            const auto buffered = static_cast<std::size_t>(std::max<int64_t>(
+                state.channel.stats().occupancy.load(
+                    std::memory_order_relaxed),
+                0));
+            const std::size_t want = std::min({max, state.deficit, buffered});
+            const std::size_t taken =
+                want > 0 ? state.channel.receive_batch(out, want) : 0;
+
+            lk.lock();
+            --in_service_;
+            state.deficit -= taken;
+            requeue(tenant, state);
+            if (!active_.empty()) {
+                cv_.notify_one();
+            } else if (closed_ && in_service_ == 0) {
+                cv_.notify_all();
+            }
+            if (taken > 0) {
+                return Turn{tenant, taken};
+            }
+        }
+    }
+
+    // Closes every tenant channel. Items already sent are still served;
+    // receive_batch() returns a zero Turn once they are gone.
+    void close() {
+        std::lock_guard<std::mutex> lk(mutex_);
+        closed_ = true;
+        for (Tenant t = 0; t < tenants_.size(); ++t) {
+            State& state = *tenants_[t];
+            state.channel.close();
+            // A sender may have pushed without registering yet.
+            if (has_items(state) && !state.queued.exchange(true)) {
+                active_.push_back(t);
+            }
+        }
+        cv_.notify_all();
+    }
+
+    const ChannelStats& stats(Tenant tenant) const {
+        return tenants_.at(tenant)->channel.stats();
+    }
+
+   private:
+    struct State {
+        explicit State(std::size_t w) : weight(w) {}
+
+        Channel<T, N> channel;
+        const std::size_t weight;
+        // Set while the tenant is in the active list or being served.
+        std::atomic<bool> queued{false};
+        // Guarded by mutex_.
+        std::size_t deficit{0};
+        bool fresh{true};
+    };
+
+    static bool has_items(const State& state) noexcept {
+        return state.channel.stats().occupancy.load(
+                   std::memory_order_relaxed) > 0;
+    }
+
+    // Pairs with the fence in requeue(): either the sender sees the tenant
+    // still queued, or the consumer sees the new item before going idle.
+    void activate(Tenant tenant, State& state) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (state.queued.load(std::memory_order_relaxed) ||
+            state.queued.exchange(true)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            active_.push_back(tenant);
+        }
+        cv_.notify_one();
+    }
+
+    // Puts a tenant that has just been served back where DRR wants it.
+    // Expects mutex_ to be held.
+    void requeue(Tenant tenant, State& state) {
+        if (has_items(state)) {
+            if (state.deficit > 0) {
+                // Its turn is not over; the next call continues it.
+                active_.push_front(tenant);
+            } else {
+                state.fresh = true;
+                active_.push_back(tenant);
+            }
+            return;
+        }
+        state.deficit = 0;
+        state.fresh = true;
+        state.queued.store(false, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (has_items(state) && !state.queued.exchange(true)) {
+            active_.push_back(tenant);
+        }
+    }
+
+    const FairSchedulerOptions options_;
+    std::vector<std::unique_ptr<State>> tenants_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Tenant> active_;
+    std::size_t in_service_{0};
+    bool closed_{false};
+};
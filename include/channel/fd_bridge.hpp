@@ -0,0 +1,353 @@
+#pragma once
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <channel/channel.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+// Move-only byte buffer backed by its own anonymous mapping, so it is always
+// page aligned and can be handed to the kernel with vmsplice. A default
+// constructed buffer is empty and owns nothing.
+class PageBuffer {
+   public:
+    PageBuffer() = default;
+
+    // Allocates at least `capacity` bytes, rounded up to whole pages.
+    explicit PageBuffer(std::size_t capacity) {
+        const std::size_t page = page_size();
+        capacity_ = std::max(page, (capacity + page - 1) / page * page);
+        void* p = ::mmap(nullptr, capacity_, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            capacity_ = 0;
+            throw std::system_error(errno, std::generic_category(), "mmap");
+        }
+        data_ = static_cast<char*>(p);
+    }
+
+    PageBuffer(PageBuffer&& other) noexcept { swap(other); }
+    PageBuffer& operator=(PageBuffer&& other) noexcept {
+        PageBuffer(std::move(other)).swap(*this);
+        return *this;
+    }
+    PageBuffer(const PageBuffer&) = delete;
+    PageBuffer& operator=(const PageBuffer&) = delete;
+
+    ~PageBuffer() { reset(); }
+
+    char* data() noexcept { return data_; }
+    const char* data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+    std::size_t capacity() const noexcept { return capacity_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    void resize(std::size_t size) {
+        if (size > capacity_) {
+            throw std::length_error("PageBuffer resize beyond capacity");
+        }
+        size_ = size;
+    }
+
+    // Appends as much of [bytes, bytes + n) as fits; returns bytes copied.
+    std::size_t append(const void* bytes, std::size_t n) noexcept {
+        const std::size_t take = std::min(n, capacity_ - size_);
+        std::memcpy(data_ + size_, bytes, take);
+        size_ += take;
+        return take;
+    }
+
+    // Unmaps the buffer. Pages already spliced into a pipe stay alive in the
+    // kernel until the reader consumes them.
+    void reset() noexcept {
+        if (data_ != nullptr) {
+            ::munmap(data_, capacity_);
+        }
+        data_ = nullptr;
+        size_ = 0;
+        capacity_ = 0;
+    }
+
+    void swap(PageBuffer& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    static std::size_t page_size() noexcept {
+        static const std::size_t page =
+            static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        return page;
+    }
+
+   private:
+    char* data_{nullptr};
+    std::size_t size_{0};
+    std::size_t capacity_{0};
+};
+
+enum class FdBridgeMode {
+    // Splice when the kernel supports it for this descriptor, else writev.
+    Auto,
+    // vmsplice straight into a pipe, or through an internal pipe and
+    // splice(2) for anything else. Fails if the kernel refuses.
+    Splice,
+    // Copying fallback: one writev per batch of buffers.
+    Writev,
+};
+
+struct FdBridgeOptions {
+    FdBridgeMode mode{FdBridgeMode::Auto};
+    // Buffers taken from the channel per lock acquisition and syscall.
+    std::size_t max_batch{16};
+};
+
+// Drains a channel of PageBuffers into a file descriptor. With splicing the
+// buffers' pages are handed to the kernel by reference instead of being
+// copied: vmsplice pins them into a pipe (the target itself, or an internal
+// pipe that splice(2) then moves to the target), and the buffer is unmapped
+// right after so user space can never modify a page the kernel still holds.
+template <int N>
+class FdBridge {
+   public:
+    explicit FdBridge(int fd, FdBridgeOptions options = {})
+        : fd_(fd), options_(options) {
+        if (options_.max_batch == 0) {
+            throw std::invalid_argument("FdBridge batch must be positive");
+        }
+        options_.max_batch =
+            std::min<std::size_t>(options_.max_batch, IOV_MAX);
+        mode_ = options_.mode;
+        if (mode_ != FdBridgeMode::Writev) {
+            struct stat st;
+            if (::fstat(fd_, &st) != 0) {
+                throw std::system_error(errno, std::generic_category(),
+                                        "fstat");
+            }
+            target_is_pipe_ = S_ISFIFO(st.st_mode);
+        }
+    }
+
+    ~FdBridge() {
+        if (pipe_[0] >= 0) ::close(pipe_[0]);
+        if (pipe_[1] >= 0) ::close(pipe_[1]);
+    }
+
+    FdBridge(const FdBridge&) = delete;
+    FdBridge& operator=(const FdBridge&) = delete;
+
+    // Writes every buffer from `ch` to the descriptor until the channel is
+    // closed and drained. Returns the number of bytes written. If writing
+    // fails, `ch` is closed before the error propagates so blocked
+    // producers do not wait forever. Writing to a pipe or socket whose
+    // reader has gone raises SIGPIPE, so processes that want the EPIPE
+    // error instead have to ignore that signal.
+    std::size_t drain(Channel<PageBuffer, N>& ch) {
+        CloseOnExit guard{ch};
+        std::vector<PageBuffer> batch;
+        batch.reserve(options_.max_batch);
+        std::size_t total = 0;
+        while (ch.receive_batch(std::back_inserter(batch),
+                                options_.max_batch) != 0) {
+            total += write_batch(batch);
+            batch.clear();
+        }
+        return total;
+    }
+
+    // Writes one batch of buffers; the buffers are consumed.
+    std::size_t write_batch(std::vector<PageBuffer>& batch) {
+        std::vector<iovec> iov;
+        iov.reserve(batch.size());
+        for (auto& buf : batch) {
+            if (!buf.empty()) iov.push_back(iovec{buf.data(), buf.size()});
+        }
+        std::size_t written = 0;
+        if (mode_ != FdBridgeMode::Writev) {
+            written = splice_all(iov);
+        }
+        if (mode_ == FdBridgeMode::Writev) {
+            written += writev_all(iov);
+        }
+        for (auto& buf : batch) {
+            buf.reset();
+        }
+        return written;
+    }
+
+    // The mode in use; Auto resolves after the first batch.
+    FdBridgeMode mode() const noexcept { return mode_; }
+
+    uint64_t bytes_spliced() const noexcept {
+        return bytes_spliced_.load(std::memory_order_relaxed);
+    }
+    uint64_t bytes_copied() const noexcept {
+        return bytes_copied_.load(std::memory_order_relaxed);
+    }
+    uint64_t syscalls() const noexcept {
+        return syscalls_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    static constexpr int kPipeSize = 1 << 20;
+
+    // Closes the channel on every way out of drain().
+    struct CloseOnExit {
+        Channel<PageBuffer, N>& channel;
+        ~CloseOnExit() { channel.close(); }
+    };
+
+    [[noreturn]] static void fail(const char* what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    // Advances `iov` past `n` bytes, dropping fully consumed entries from
+    // the front.
+    static void advance(std::vector<iovec>& iov, std::size_t& first,
+                        std::size_t n) {
+        while (n > 0) {
+            iovec& v = iov[first];
+            const std::size_t step = std::min(n, v.iov_len);
+            v.iov_base = static_cast<char*>(v.iov_base) + step;
+            v.iov_len -= step;
+            n -= step;
+            if (v.iov_len == 0) ++first;
+        }
+    }
+
+    // Returns true if the error means splicing is unsupported here, in
+    // which case Auto falls back to writev for the rest of the stream.
+    bool unsupported(int err) const noexcept {
+        return mode_ == FdBridgeMode::Auto &&
+               (err == EINVAL || err == ENOSYS || err == EBADF ||
+                err == EOPNOTSUPP);
+    }
+
+    // Splices as much of `iov` as possible. On an unsupported target in
+    // Auto mode it switches to writev and leaves the rest of `iov` (already
+    // trimmed) for the caller.
+    std::size_t splice_all(std::vector<iovec>& iov) {
+        std::size_t first = 0;
+        std::size_t total = 0;
+        if (!target_is_pipe_ && pipe_[0] < 0) {
+            if (::pipe2(pipe_, O_CLOEXEC) != 0) fail("pipe2");
+            // Best effort; a larger pipe means fewer round trips.
+            ::fcntl(pipe_[1], F_SETPIPE_SZ, kPipeSize);
+        }
+        const int sink = target_is_pipe_ ? fd_ : pipe_[1];
+        while (first < iov.size()) {
+            const std::size_t count =
+                std::min<std::size_t>(iov.size() - first, IOV_MAX);
+            const ssize_t n =
+                ::vmsplice(sink, &iov[first], count, SPLICE_F_GIFT);
+            syscalls_.fetch_add(1, std::memory_order_relaxed);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (unsupported(errno) && total == 0) {
+                    mode_ = FdBridgeMode::Writev;
+                    break;
+                }
+                fail("vmsplice");
+            }
+            if (!target_is_pipe_ &&
+                !move_from_pipe(static_cast<std::size_t>(n), total == 0)) {
+                // The buffers are still mapped and `iov` is untouched, so
+                // writev picks up from exactly where splicing stopped.
+                mode_ = FdBridgeMode::Writev;
+                break;
+            }
+            advance(iov, first, static_cast<std::size_t>(n));
+            total += static_cast<std::size_t>(n);
+            bytes_spliced_.fetch_add(n, std::memory_order_relaxed);
+        }
+        if (mode_ == FdBridgeMode::Auto) {
+            mode_ = FdBridgeMode::Splice;
+        }
+        iov.erase(iov.begin(), iov.begin() + first);
+        return total;
+    }
+
+    // Moves exactly `n` bytes from the internal pipe to the target. If the
+    // target refuses splice before anything reached it and `may_fall_back`
+    // is set, empties the pipe and returns false instead of throwing.
+    bool move_from_pipe(std::size_t n, bool may_fall_back) {
+        bool moved_any = false;
+        while (n > 0) {
+            const ssize_t moved = ::splice(pipe_[0], nullptr, fd_, nullptr, n,
+                                           SPLICE_F_MOVE | SPLICE_F_MORE);
+            syscalls_.fetch_add(1, std::memory_order_relaxed);
+            if (moved < 0) {
+                if (errno == EINTR) continue;
+                if (may_fall_back && !moved_any && unsupported(errno)) {
+                    discard_pipe(n);
+                    return false;
+                }
+                fail("splice");
+            }
+            if (moved == 0) {
+                errno = EPIPE;
+                fail("splice");
+            }
+            n -= static_cast<std::size_t>(moved);
+            moved_any = true;
+        }
+        return true;
+    }
+
+    void discard_pipe(std::size_t n) {
+        char scratch[4096];
+        while (n > 0) {
+            const ssize_t got =
+                ::read(pipe_[0], scratch, std::min(n, sizeof(scratch)));
+            if (got < 0) {
+                if (errno == EINTR) continue;
+                fail("read");
+            }
+            n -= static_cast<std::size_t>(got);
+        }
+    }
+
+    std::size_t writev_all(std::vector<iovec>& iov) {
+        std::size_t first = 0;
+        std::size_t total = 0;
+        while (first < iov.size()) {
+            const int count =
+                static_cast<int>(std::min<std::size_t>(iov.size() - first,
+                                                       IOV_MAX));
+            const ssize_t n = ::writev(fd_, &iov[first], count);
+            syscalls_.fetch_add(1, std::memory_order_relaxed);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                fail("writev");
+            }
+            advance(iov, first, static_cast<std::size_t>(n));
+            total += static_cast<std::size_t>(n);
+            bytes_copied_.fetch_add(n, std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    const int fd_;
+    FdBridgeOptions options_;
+    FdBridgeMode mode_;
+    bool target_is_pipe_{false};
+    int pipe_[2]{-1, -1};
+
+    std::atomic<uint64_t> bytes_spliced_{0};
+    std::atomic<uint64_t> bytes_copied_{0};
+    std::atomic<uint64_t> syscalls_{0};
+};
@@ -0,0 +1,468 @@
+#pragma once
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <channel/channel.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+enum class IoOp { Write, Fsync };
+
+struct IoRequest {
+    IoOp op{IoOp::Write};
+    int fd{-1};
+    // File offset for writes; negative means the current file position
+    // (the only choice for pipes and sockets).
+    int64_t offset{-1};
+    // Bytes to write; owned by the request until it completes.
+    std::string data;
+    // Returned untouched in the completion.
+    uint64_t user_data{0};
+};
+
+struct IoCompletion {
+    IoOp op{IoOp::Write};
+    uint64_t user_data{0};
+    // Bytes written (possibly short, as with write(2)), 0 for a successful
+    // fsync, or -errno.
+    int64_t result{0};
+};
+
+enum class IoBackend {
+    // io_uring when the kernel offers it, otherwise ThreadPool.
+    Auto,
+    IoUring,
+    // Blocking write/fsync on worker threads.
+    ThreadPool,
+};
+
+struct IoStageOptions {
+    IoBackend backend{IoBackend::Auto};
+    // Most requests in flight at once: the ring size for io_uring, the
+    // hand-off depth for the thread pool.
+    unsigned queue_depth{64};
+    std::size_t threads{4};
+};
+
+// Takes write and fsync requests from a channel, executes them
+// asynchronously and reports each one on a completion channel, so the
+// producers never block in the kernel themselves. Requests and Completions
+// are channel types with Channel's batch API carrying IoRequest and
+// IoCompletion.
+//
+// With io_uring every batch pulled from the request channel becomes one
+// io_uring_enter call that both submits and reaps. The ring is driven with
+// raw syscalls; liburing is not needed. Kernels without io_uring (or
+// without current-position writes, added in 5.6) get the thread-pool
+// backend instead when the backend is Auto.
+//
+// Requests in flight together may complete in any order, so writes to the
+// same file should use explicit offsets. Fsync is a barrier: it starts only
+// after every earlier request has completed, and later requests wait for it.
+template <class Requests, class Completions>
+class IoStage {
+    static_assert(std::is_same<typename Requests::value_type,
+                               IoRequest>::value,
+                  "Requests must carry IoRequest");
+    static_assert(std::is_same<typename Completions::value_type,
+                               IoCompletion>::value,
+                  "Completions must carry IoCompletion");
+
+   public:
+    explicit IoStage(IoStageOptions options = {}) : options_(options) {
+        if (options_.queue_depth == 0 || options_.threads == 0) {
+            throw std::invalid_argument("IoStage needs depth and threads");
+        }
+        backend_ = options_.backend;
+        if (backend_ != IoBackend::ThreadPool) {
+            const int err = ring_.setup(options_.queue_depth);
+            if (err == 0) {
+                backend_ = IoBackend::IoUring;
+            } else if (backend_ == IoBackend::Auto) {
+                backend_ = IoBackend::ThreadPool;
+            } else {
+                throw std::system_error(err, std::generic_category(),
+                                        "io_uring_setup");
+            }
+        }
+    }
+
+    IoStage(const IoStage&) = delete;
+    IoStage& operator=(const IoStage&) = delete;
+
+    // Executes requests until `requests` is closed and drained and every
+    // completion has been delivered, then closes `completions`. If the
+    // stage fails (io_uring_enter errors, or `completions` is closed under
+    // it) both channels are closed before the error propagates, so neither
+    // producers nor consumers wait forever.
+    void run(Requests& requests, Completions& completions) {
+        CloseOnExit guard{completions};
+        try {
+            if (backend_ == IoBackend::IoUring) {
+                run_ring(requests, completions);
+            } else {
+                run_pool(requests, completions);
+            }
+        } catch (...) {
+            requests.close();
+            throw;
+        }
+    }
+
+    // The backend in use; never Auto.
+    IoBackend backend() const noexcept { return backend_; }
+
+   private:
+    // Minimal io_uring binding: the three mappings plus submit and reap.
+    class Ring {
+       public:
+        Ring() = default;
+        Ring(const Ring&) = delete;
+        Ring& operator=(const Ring&) = delete;
+
+        ~Ring() {
+            if (sqes_ != nullptr) ::munmap(sqes_, sqes_size_);
+            if (cq_ptr_ != nullptr && cq_ptr_ != sq_ptr_) {
+                ::munmap(cq_ptr_, cq_size_);
+            }
+            if (sq_ptr_ != nullptr) ::munmap(sq_ptr_, sq_size_);
+            if (fd_ >= 0) ::close(fd_);
+        }
+
+        // Returns 0 or an errno value.
+        int setup(unsigned entries) {
+            io_uring_params params;
+            std::memset(&params, 0, sizeof(params));
+            fd_ = static_cast<int>(
+                ::syscall(__NR_io_uring_setup, entries, &params));
+            if (fd_ < 0) return errno;
+            if ((params.features & IORING_FEAT_RW_CUR_POS) == 0) {
+                return ENOTSUP;
+            }
+
+            sq_size_ =
+                params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cq_size_ = params.cq_off.cqes +
+                       params.cq_entries * sizeof(io_uring_cqe);
+            const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+            if (single) sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+
+            sq_ptr_ = map(sq_size_, IORING_OFF_SQ_RING);
+            if (sq_ptr_ == nullptr) return errno;
+            cq_ptr_ = single ? sq_ptr_ : map(cq_size_, IORING_OFF_CQ_RING);
+            if (cq_ptr_ == nullptr) return errno;
+            sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+            sqes_ = static_cast<io_uring_sqe*>(
+                map(sqes_size_, IORING_OFF_SQES));
+            if (sqes_ == nullptr) return errno;
+
+            char* sq = static_cast<char*>(sq_ptr_);
+            sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            sq_mask_ =
+                *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            char* cq = static_cast<char*>(cq_ptr_);
+            cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            cq_mask_ =
+                *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+            entries_ = params.sq_entries;
+            local_tail_ = *sq_tail_;
+            return 0;
+        }
+
+        unsigned entries() const noexcept { return entries_; }
+
+        // Queues an entry; the caller keeps in-flight entries within
+        // entries(), so the ring always has room.
+        io_uring_sqe& next_sqe() {
+            const unsigned idx = local_tail_++ & sq_mask_;
+            sq_array_[idx] = idx;
+            ++pending_;
+            io_uring_sqe& sqe = sqes_[idx];
+            std::memset(&sqe, 0, sizeof(sqe));
+            return sqe;
+        }
+
+        // Publishes queued entries and waits for at least `wait_for`
+        // completions.
+        void enter(unsigned wait_for) {
+            __atomic_store_n(sq_tail_, local_tail_, __ATOMIC_RELEASE);
+            while (true) {
+                const long submitted = ::syscall(
+                    __NR_io_uring_enter, fd_, pending_, wait_for,
+                    wait_for > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+                if (submitted >= 0) {
+                    pending_ -= static_cast<unsigned>(submitted);
+                    if (pending_ == 0 || wait_for > 0) return;
+                    continue;
+                }
+                // EBUSY/EAGAIN: the completion queue needs reaping first;
+                // whatever was not submitted stays queued for next time.
+                if (errno == EBUSY || errno == EAGAIN) return;
+                if (errno != EINTR) {
+                    throw std::system_error(errno, std::generic_category(),
+                                            "io_uring_enter");
+                }
+            }
+        }
+
+        // Calls fn(const io_uring_cqe&) for every available completion.
+        template <class Fn>
+        std::size_t reap(Fn&& fn) {
+            unsigned head = *cq_head_;
+            const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            const std::size_t count = tail - head;
+            for (; head != tail; ++head) {
+                fn(cqes_[head & cq_mask_]);
+            }
+            __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+            return count;
+        }
+
+       private:
+        void* map(std::size_t size, off_t offset) {
+            void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, fd_, offset);
+            return p == MAP_FAILED ? nullptr : p;
+        }
+
+        int fd_{-1};
+        void* sq_ptr_{nullptr};
+        void* cq_ptr_{nullptr};
+        std::size_t sq_size_{0};
+        std::size_t cq_size_{0};
+        io_uring_sqe* sqes_{nullptr};
+        std::size_t sqes_size_{0};
+        unsigned* sq_tail_{nullptr};
+        unsigned* sq_array_{nullptr};
+        unsigned sq_mask_{0};
+        unsigned* cq_head_{nullptr};
+        unsigned* cq_tail_{nullptr};
+        unsigned cq_mask_{0};
+        io_uring_cqe* cqes_{nullptr};
+        unsigned entries_{0};
+        // Our copy of the submission tail, published by enter().
+        unsigned local_tail_{0};
+        // Entries queued but not yet accepted by the kernel.
+        unsigned pending_{0};
+    };
+
+    struct CloseOnExit {
+        Completions& channel;
+        ~CloseOnExit() { channel.close(); }
+    };
+
+    // A request owned by the stage while the kernel may still read it.
+    struct Slot {
+        IoRequest request;
+        iovec iov{};
+    };
+
+    // Waits out the requests still in flight when run_ring() leaves by an
+    // exception, so the kernel is done with their iovecs and data before
+    // the slots are freed. Their completions are dropped. Should even that
+    // wait fail, the slots are leaked rather than freed under the kernel.
+    struct Settle {
+        Ring& ring;
+        std::unique_ptr<Slot[]>& slots;
+        unsigned& inflight;
+
+        ~Settle() {
+            while (inflight > 0) {
+                try {
+                    ring.enter(1);
+                } catch (const std::system_error&) {
+                    slots.release();
+                    return;
+                }
+                inflight -= static_cast<unsigned>(
+                    ring.reap([](const io_uring_cqe&) {}));
+            }
+        }
+    };
+
+    void run_ring(Requests& requests, Completions& completions) {
+        const unsigned depth = ring_.entries();
+        std::unique_ptr<Slot[]> slots(new Slot[depth]);
+        std::vector<unsigned> free_slots;
+        for (unsigned i = depth; i > 0; --i) free_slots.push_back(i - 1);
+
+        std::vector<IoRequest> batch;
+        std::vector<IoCompletion> done;
+        unsigned inflight = 0;
+        Settle settle{ring_, slots, inflight};
+        bool draining = false;
+        while (!draining || inflight > 0) {
+            batch.clear();
+            const std::size_t room = depth - inflight;
+            if (!draining && room > 0) {
+                // Block only when nothing is in flight; otherwise take what
+                // is ready and go back to reaping.
+                if (inflight == 0) {
+                    draining = requests.receive_batch(
+                                   std::back_inserter(batch), room) == 0;
+                } else {
+                    requests.try_receive_batch(std::back_inserter(batch),
+                                               room);
+                }
+            }
+
+            for (auto& request : batch) {
+                const unsigned id = free_slots.back();
+                free_slots.pop_back();
+                Slot& slot = slots[id];
+                slot.request = std::move(request);
+                io_uring_sqe& sqe = ring_.next_sqe();
+                sqe.fd = slot.request.fd;
+                sqe.user_data = id;
+                if (slot.request.op == IoOp::Fsync) {
+                    sqe.opcode = IORING_OP_FSYNC;
+                    sqe.flags = IOSQE_IO_DRAIN;
+                } else {
+                    slot.iov.iov_base = slot.request.data.data();
+                    slot.iov.iov_len = slot.request.data.size();
+                    sqe.opcode = IORING_OP_WRITEV;
+                    sqe.addr = reinterpret_cast<uint64_t>(&slot.iov);
+                    sqe.len = 1;
+                    sqe.off = static_cast<uint64_t>(slot.request.offset);
+                }
+                ++inflight;
+            }
+
+            if (inflight == 0) continue;
+            // Wait for a completion only if this round brought nothing new.
+            ring_.enter(batch.empty() ? 1 : 0);
+
+            done.clear();
+            ring_.reap([&](const io_uring_cqe& cqe) {
+                const auto id = static_cast<unsigned>(cqe.user_data);
+                Slot& slot = slots[id];
+                done.push_back(IoCompletion{slot.request.op,
+                                            slot.request.user_data, cqe.res});
+                slot.request = IoRequest{};
+                free_slots.push_back(id);
+            });
+            inflight -= static_cast<unsigned>(done.size());
+            completions.send_batch(std::make_move_iterator(done.begin()),
+                                   std::make_move_iterator(done.end()));
+        }
+    }
+
+    static IoCompletion execute(IoRequest& request) {
+        IoCompletion completion{request.op, request.user_data, 0};
+        if (request.op == IoOp::Fsync) {
+            if (::fsync(request.fd) != 0) completion.result = -errno;
+            return completion;
+        }
+        ssize_t n;
+        do {
+            n = request.offset < 0
+                    ? ::write(request.fd, request.data.data(),
+                              request.data.size())
+                    : ::pwrite(request.fd, request.data.data(),
+                               request.data.size(), request.offset);
+        } while (n < 0 && errno == EINTR);
+        completion.result = n < 0 ? -errno : n;
+        return completion;
+    }
+
+    // The calling thread dispatches in request order; workers execute and
+    // report. A fsync is run by the dispatcher itself once the workers have
+    // gone idle, which holds back everything after it as well.
+    void run_pool(Requests& requests, Completions& completions) {
+        Channel<IoRequest, kPoolDepth> jobs;
+        std::mutex idle_mutex;
+        std::condition_variable idle_cv;
+        std::size_t inflight = 0;
+        // The first failure, guarded by idle_mutex. An exception must not
+        // escape a worker thread, so workers record it here and stop the
+        // dispatcher by closing both channels feeding them; it is rethrown
+        // once every thread has finished.
+        std::exception_ptr error;
+        std::atomic<bool> failed{false};
+        auto fail = [&](std::exception_ptr e) {
+            {
+                std::lock_guard<std::mutex> lk(idle_mutex);
+                if (!error) error = std::move(e);
+            }
+            failed.store(true, std::memory_order_relaxed);
+            jobs.close();
+            requests.close();
+        };
+
+        std::vector<std::thread> workers;
+        try {
+            for (std::size_t i = 0; i < options_.threads; ++i) {
+                workers.emplace_back([&]() {
+                    while (auto job = jobs.receive()) {
+                        // After a failure, drop what is left unexecuted.
+                        if (!failed.load(std::memory_order_relaxed)) {
+                            try {
+                                completions.send(execute(*job));
+                            } catch (...) {
+                                fail(std::current_exception());
+                            }
+                        }
+                        std::lock_guard<std::mutex> lk(idle_mutex);
+                        if (--inflight == 0) idle_cv.notify_all();
+                    }
+                });
+            }
+
+            std::vector<IoRequest> batch;
+            while (requests.receive_batch(std::back_inserter(batch),
+                                          options_.queue_depth) != 0) {
+                for (auto& request : batch) {
+                    if (request.op == IoOp::Fsync) {
+                        std::unique_lock<std::mutex> lk(idle_mutex);
+                        idle_cv.wait(lk, [&]() { return inflight == 0; });
+                        lk.unlock();
+                        completions.send(execute(request));
+                        continue;
+                    }
+                    {
+                        std::lock_guard<std::mutex> lk(idle_mutex);
+                        ++inflight;
+                    }
+                    jobs.send(std::move(request));
+                }
+                batch.clear();
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+        jobs.close();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        if (error) std::rethrow_exception(error);
+    }
+
+    static constexpr int kPoolDepth = 64;
+
+    IoStageOptions options_;
+    IoBackend backend_;
+    Ring ring_;
+};
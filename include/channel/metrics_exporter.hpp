@@ -0,0 +1,291 @@
+#pragma once
+
+#include <channel/channel_registry.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class MetricsFormat { Prometheus, Json };
+
+struct MetricsExporterOptions {
+    MetricsFormat format{MetricsFormat::Prometheus};
+    // Destination file. Empty writes to stdout. Files are replaced
+    // atomically (write to a temporary, then rename) so scrapers never see
+    // a partial export; a failed write leaves the previous one in place.
+    std::string path;
+    std::chrono::milliseconds interval{1000};
+};
+
+// Periodically renders every channel in a ChannelRegistry. Rates are
+// computed from the counter deltas between two consecutive exports, so the
+// first export after a channel appears reports a rate of zero.
+class MetricsExporter {
+   public:
+    explicit MetricsExporter(
+        MetricsExporterOptions options,
+        ChannelRegistry& registry = ChannelRegistry::instance())
+        : options_(std::move(options)), registry_(registry) {}
+
+    ~MetricsExporter() { stop(); }
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // Starts exporting every `interval` on a background thread.
+    void start() {
+        std::lock_guard<std::mutex> lk(thread_mutex_);
+        if (worker_.joinable()) {
+            return;
+        }
+        stopping_ = false;
+        worker_ = std::thread([this]() { run(); });
+    }
+
+    // Stops the background thread after one final export.
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lk(thread_mutex_);
+            if (!worker_.joinable()) {
+                return;
+            }
+            stopping_ = true;
+        }
+        stop_cv_.notify_all();
+        worker_.join();
+    }
+
+    // Renders the current state in the configured format.
+    std::string render() {
+        return render_at(std::chrono::steady_clock::now());
+    }
+
+    // Renders and writes one export to the configured destination.
+    void export_once() { write(render()); }
+
+   private:
+    struct Row {
+        ChannelStats::Snapshot stats;
+        double send_rate{0.0};
+        double receive_rate{0.0};
+    };
+
+    struct Previous {
+        uint64_t sent{0};
+        uint64_t received{0};
+    };
+
+    void run() {
+        std::unique_lock<std::mutex> lk(thread_mutex_);
+        while (!stopping_) {
+            stop_cv_.wait_for(lk, options_.interval,
+                              [this]() { return stopping_; });
+            lk.unlock();
+            try {
+                export_once();
+            } catch (const std::exception& e) {
+                // Keep exporting; the destination may come back.
+                std::cerr << "metrics export failed: " << e.what() << '\n';
+            }
+            lk.lock();
+        }
+    }
+
+    std::string render_at(std::chrono::steady_clock::time_point now) {
+        std::lock_guard<std::mutex> lk(render_mutex_);
+        const auto entries = registry_.snapshot();
+        const double elapsed =
+            have_previous_
+                ? std::chrono::duration<double>(now - previous_time_).count()
+                : 0.0;
+
+        std::vector<Row> rows;
+        rows.reserve(entries->size());
+        std::map<const ChannelStats*, Previous> current;
+        for (const auto& entry : *entries) {
+            Row row{entry->snapshot()};
+            const auto prev = previous_.find(entry.get());
+            if (prev != previous_.end() && elapsed > 0.0) {
+                row.send_rate = (row.stats.sent - prev->second.sent) / elapsed;
+                row.receive_rate =
+                    (row.stats.received - prev->second.received) / elapsed;
+            }
+            current[entry.get()] = Previous{row.stats.sent, row.stats.received};
+            rows.push_back(std::move(row));
+        }
+
+        // Holding on to the entries keeps their addresses from being reused
+        // by a new channel before the next export compares against them.
+        previous_entries_ = entries;
+        previous_ = std::move(current);
+        previous_time_ = now;
+        have_previous_ = true;
+
+        return options_.format == MetricsFormat::Json ? render_json(rows)
+                                                      : render_prometheus(rows);
+    }
+
+    static std::string render_prometheus(const std::vector<Row>& rows) {
+        std::ostringstream out;
+        out << std::setprecision(6) << std::fixed;
+        auto family = [&](const char* name, const char* type,
+                          const char* help, auto value) {
+            out << "# HELP " << name << ' ' << help << '\n';
+            out << "# TYPE " << name << ' ' << type << '\n';
+            for (const auto& row : rows) {
+                out << name << "{channel=\"" << escape_label(row.stats.name)
+                    << "\"} " << value(row) << '\n';
+            }
+        };
+        family("channel_capacity", "gauge", "Buffer capacity in items.",
+               [](const Row& r) { return r.stats.capacity; });
+        family("channel_occupancy", "gauge", "Items currently buffered.",
+               [](const Row& r) { return r.stats.occupancy; });
+        family("channel_sent_total", "counter", "Items sent.",
+               [](const Row& r) { return r.stats.sent; });
+        family("channel_received_total", "counter", "Items received.",
+               [](const Row& r) { return r.stats.received; });
+        family("channel_dropped_total", "counter",
+               "Items dropped by active queue management.",
+               [](const Row& r) { return r.stats.dropped; });
+        family("channel_order_switches_total", "counter",
+               "Adaptive ordering switches between FIFO and LIFO.",
+               [](const Row& r) { return r.stats.order_switches; });
+        family("channel_send_rate", "gauge",
+               "Items sent per second since the previous export.",
+               [](const Row& r) { return r.send_rate; });
+        family("channel_receive_rate", "gauge",
+               "Items received per second since the previous export.",
+               [](const Row& r) { return r.receive_rate; });
+        family("channel_blocked_senders", "gauge",
+               "Senders waiting for buffer space.",
+               [](const Row& r) { return r.stats.blocked_senders; });
+        family("channel_blocked_receivers", "gauge",
+               "Receivers waiting for data.",
+               [](const Row& r) { return r.stats.blocked_receivers; });
+        family("channel_throttled_seconds_total", "counter",
+               "Time receivers waited for a rate-limit token.",
+               [](const Row& r) { return r.stats.throttled_ns / 1e9; });
+        family("channel_closed", "gauge", "1 once the channel is closed.",
+               [](const Row& r) { return r.stats.closed ? 1 : 0; });
+        return out.str();
+    }
+
+    static std::string render_json(const std::vector<Row>& rows) {
+        std::ostringstream out;
+        out << std::setprecision(6) << std::fixed;
+        out << "{\"channels\":[";
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            const Row& r = rows[i];
+            if (i != 0) out << ',';
+            out << "{\"name\":\"" << escape_json(r.stats.name) << '"'
+                << ",\"capacity\":" << r.stats.capacity
+                << ",\"occupancy\":" << r.stats.occupancy
+                << ",\"sent_total\":" << r.stats.sent
+                << ",\"received_total\":" << r.stats.received
+                << ",\"dropped_total\":" << r.stats.dropped
+                << ",\"order_switches_total\":" << r.stats.order_switches
+                << ",\"send_rate\":" << r.send_rate
+                << ",\"receive_rate\":" << r.receive_rate
+                << ",\"blocked_senders\":" << r.stats.blocked_senders
+                << ",\"blocked_receivers\":" << r.stats.blocked_receivers
+                << ",\"throttled_seconds_total\":"
+                << r.stats.throttled_ns / 1e9
+                << ",\"closed\":" << (r.stats.closed ? "true" : "false")
+                << '}';
+        }
+        out << "]}\n";
+        return out.str();
+    }
+
+    static std::string escape_label(const std::string& in) {
+        std::string out;
+        for (char c : in) {
+            if (c == '\\' || c == '"') {
+                out += '\\';
+                out += c;
+            } else if (c == '\n') {
+                out += "\\n";
+            } else {
+                out += c;
+            }
+        }
+        return out;
+    }
+
+    static std::string escape_json(const std::string& in) {
+        std::string out;
+        for (char c : in) {
+            switch (c) {
+                case '"':
+                    out += "\\\"";
+                    break;
+                case '\\':
+                    out += "\\\\";
+                    break;
+                case '\n':
+                    out += "\\n";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char buf[8];
+                        std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                        out += buf;
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+        return out;
+    }
+
+    void write(const std::string& text) {
+        if (options_.path.empty()) {
+            std::cout << text << std::flush;
+            return;
+        }
+        const std::string tmp = options_.path + ".tmp";
+        {
+            std::ofstream file(tmp, std::ios::trunc);
+            if (!file) {
+                throw std::runtime_error("Cannot open metrics file " + tmp);
+            }
+            file << text;
+            // close() flushes; a full disk shows up here, and renaming the
+            // truncated file would replace a good export with a partial one.
+            file.close();
+            if (!file) {
+                std::remove(tmp.c_str());
+                throw std::runtime_error("Cannot write metrics file " + tmp);
+            }
+        }
+        if (std::rename(tmp.c_str(), options_.path.c_str()) != 0) {
+            throw std::runtime_error("Cannot replace metrics file " +
+                                     options_.path);
+        }
+    }
+
+    const MetricsExporterOptions options_;
+    ChannelRegistry& registry_;
+
+    std::mutex render_mutex_;
+    std::shared_ptr<const ChannelRegistry::Entries> previous_entries_;
+    std::map<const ChannelStats*, Previous> previous_;
+    std::chrono::steady_clock::time_point previous_time_{};
+    bool have_previous_{false};
+
+    std::mutex thread_mutex_;
+    std::condition_variable stop_cv_;
+    bool stopping_{false};
+    std::thread worker_;
+};
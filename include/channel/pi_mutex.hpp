@@ -0,0 +1,121 @@
+#pragma once
+
+#include <pthread.h>
+#include <time.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <system_error>
+
+// A mutex whose owner inherits the priority of the highest-priority thread
+// blocked on it (PTHREAD_PRIO_INHERIT, backed by a PI futex on Linux). With
+// real-time threads this bounds how long a high-priority waiter can be held
+// up by a low-priority owner that keeps getting preempted by medium-priority
+// work. Meets the Lockable requirements, so it works with std::unique_lock.
+class PiMutex {
+   public:
+    using native_handle_type = pthread_mutex_t*;
+
+    PiMutex() {
+        pthread_mutexattr_t attr;
+        ::pthread_mutexattr_init(&attr);
+        int err = ::pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+        if (err == 0) {
+            err = ::pthread_mutex_init(&mutex_, &attr);
+        }
+        ::pthread_mutexattr_destroy(&attr);
+        if (err != 0) {
+            throw std::system_error(err, std::generic_category(),
+                                    "pthread_mutex_init");
+        }
+    }
+
+    ~PiMutex() { ::pthread_mutex_destroy(&mutex_); }
+
+    PiMutex(const PiMutex&) = delete;
+    PiMutex& operator=(const PiMutex&) = delete;
+
+    void lock() {
+        const int err = ::pthread_mutex_lock(&mutex_);
+        if (err != 0) {
+            throw std::system_error(err, std::generic_category(),
+                                    "pthread_mutex_lock");
+        }
+    }
+
+    bool try_lock() noexcept { return ::pthread_mutex_trylock(&mutex_) == 0; }
+
+    void unlock() noexcept { ::pthread_mutex_unlock(&mutex_); }
+
+    native_handle_type native_handle() noexcept { return &mutex_; }
+
+   private:
+    pthread_mutex_t mutex_;
+};
+
+// Condition variable for PiMutex. Waiting releases and reacquires the PI
+// mutex itself, so the priority boost also covers the relock after a
+// wakeup (std::condition_variable_any would go through a second, plain
+// mutex).
+class PiConditionVariable {
+   public:
+    PiConditionVariable() {
+        pthread_condattr_t attr;
+        ::pthread_condattr_init(&attr);
+        ::pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        const int err = ::pthread_cond_init(&cond_, &attr);
+        ::pthread_condattr_destroy(&attr);
+        if (err != 0) {
+            throw std::system_error(err, std::generic_category(),
+                                    "pthread_cond_init");
+        }
+    }
+
+    ~PiConditionVariable() { ::pthread_cond_destroy(&cond_); }
+
+    PiConditionVariable(const PiConditionVariable&) = delete;
+    PiConditionVariable& operator=(const PiConditionVariable&) = delete;
+
+    void notify_one() noexcept { ::pthread_cond_signal(&cond_); }
+
+    void notify_all() noexcept { ::pthread_cond_broadcast(&cond_); }
+
+    void wait(std::unique_lock<PiMutex>& lk) {
+        ::pthread_cond_wait(&cond_, lk.mutex()->native_handle());
+    }
+
+    template <class Pred>
+    void wait(std::unique_lock<PiMutex>& lk, Pred ready) {
+        while (!ready()) {
+            wait(lk);
+        }
+    }
+
+    // The condition clock is CLOCK_MONOTONIC, which is what steady_clock
+    // reads on Linux.
+    template <class Duration>
+    std::cv_status wait_until(
+        std::unique_lock<PiMutex>& lk,
+        const std::chrono::time_point<std::chrono::steady_clock, Duration>&
+            deadline) {
+        const int64_t ns = std::max<int64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                deadline.time_since_epoch())
+                .count(),
+            0);
+        timespec ts;
+        ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+        ts.tv_nsec = static_cast<long>(ns % 1000000000);
+        return ::pthread_cond_timedwait(&cond_, lk.mutex()->native_handle(),
+                                        &ts) == ETIMEDOUT
+                   ? std::cv_status::timeout
+                   : std::cv_status::no_timeout;
+    }
+
+   private:
+    pthread_cond_t cond_;
+};
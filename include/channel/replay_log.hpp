@@ -0,0 +1,385 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct ReplayLogOptions {
+    // Entries per segment. Retention always trims whole segments.
+    std::size_t segment_capacity{1024};
+    // Keep at most this many segments, including the one being written.
+    // Zero keeps everything.
+    std::size_t max_segments{0};
+    // Trim sealed segments once they have been full for this long. Zero
+    // disables age-based retention.
+    std::chrono::steady_clock::duration max_age{0};
+    // Trimmed segments kept around for reuse instead of being freed.
+    std::size_t pooled_segments{4};
+    // Source of segment and bookkeeping memory; null means the default
+    // resource. Must outlive the log.
+    std::pmr::memory_resource* resource{nullptr};
+};
+
+// In-memory append-only log split into fixed-size segments. Entries are
+// addressed by a monotonically increasing offset and stay readable until
+// retention trims their segment. Independent consumer groups each track
+// their own position: members of one group share the work by claiming
+// offsets from a single atomic cursor, and a group can rewind to its last
+// committed offset (or any retained offset) to replay after a failure.
+template <typename T>
+class ReplayLog {
+   public:
+    struct Record {
+        uint64_t offset;
+        T value;
+    };
+
+    class closed_error : public std::runtime_error {
+       public:
+        closed_error(std::string m) : std::runtime_error(m) {}
+    };
+
+    enum class StartFrom { Earliest, Latest };
+
+    class ConsumerGroup {
+       public:
+        ConsumerGroup(const ConsumerGroup&) = delete;
+        ConsumerGroup& operator=(const ConsumerGroup&) = delete;
+
+        // Claims the next offset for the calling member and returns its
+        // record, waiting for new appends if the group has caught up.
+        // Returns nullopt once the log is closed and the group is drained.
+        std::optional<Record> poll() { return next(true); }
+
+        // Like poll() but returns nullopt instead of waiting.
+        std::optional<Record> try_poll() { return next(false); }
+
+        // Records that everything up to and including `offset` has been
+        // processed. Commits only ever move forward.
+        void commit(uint64_t offset) noexcept {
+            uint64_t cur = committed_.load(std::memory_order_relaxed);
+            while (cur < offset + 1 &&
+                   !committed_.compare_exchange_weak(
+                       cur, offset + 1, std::memory_order_release,
+                       std::memory_order_relaxed)) {
+            }
+        }
+
+        // The first offset that has not been committed.
+        uint64_t committed() const noexcept {
+            return committed_.load(std::memory_order_acquire);
+        }
+
+        // The next offset a member will claim.
+        uint64_t position() const noexcept {
+            return next_.load(std::memory_order_acquire);
+        }
+
+        // Moves the group's read position. Offsets that were already trimmed
+        // are skipped on the next poll.
+        void seek(uint64_t offset) noexcept {
+            next_.store(offset, std::memory_order_release);
+        }
+
+        // Replays everything after the last commit.
+        void rewind_to_committed() noexcept { seek(committed()); }
+
+       private:
+        friend class ReplayLog;
+
+        ConsumerGroup(ReplayLog& log, uint64_t start)
+            : log_(log), next_(start), committed_(start) {}
+
+        std::optional<Record> next(bool wait) {
+            while (true) {
+                uint64_t cur = next_.load(std::memory_order_acquire);
+                const uint64_t start = log_.start_offset();
+                if (cur < start) {
+                    next_.compare_exchange_weak(cur, start,
+                                                std::memory_order_acq_rel);
+                    continue;
+                }
+                if (cur >= log_.end_offset()) {
+                    if (!wait || !log_.wait_for_offset(cur)) {
+                        return std::nullopt;
+                    }
+                    continue;
+                }
+                if (!next_.compare_exchange_weak(cur, cur + 1,
+                                                 std::memory_order_acq_rel)) {
+                    continue;
+                }
+                auto value = log_.read(cur);
+                if (value.has_value()) {
+                    return Record{cur, std::move(*value)};
+                }
+                // Trimmed between the claim and the read; move on.
+            }
+        }
+
+        ReplayLog& log_;
+        alignas(64) std::atomic<uint64_t> next_;
+        alignas(64) std::atomic<uint64_t> committed_;
+    };
+
+    explicit ReplayLog(ReplayLogOptions options = {})
+        : options_(options),
+          resource_(options.resource != nullptr
+                        ? options.resource
+                        : std::pmr::get_default_resource()),
+          segments_(resource_),
+          pool_(resource_) {
+        if (options_.segment_capacity == 0) {
+            throw std::invalid_argument("segment_capacity must be positive");
+        }
+        segments_.push_back(acquire_segment(0));
+    }
+    ReplayLog(const ReplayLog&) = delete;
+    ReplayLog& operator=(const ReplayLog&) = delete;
+
+    uint64_t append(const T& value) { return emplace(value); }
+    uint64_t append(T&& value) { return emplace(std::move(value)); }
+
+    // Returns a copy of the entry at `offset`, or nullopt when it has been
+    // trimmed or not written yet.
+    std::optional<T> read(uint64_t offset) const {
+        std::shared_lock<std::shared_mutex> lk(segments_mutex_);
+        if (offset < start_offset_.load(std::memory_order_relaxed) ||
+            offset >= end_offset_.load(std::memory_order_acquire)) {
+            return std::nullopt;
+        }
+        const Segment& head = *segments_.front();
+        const std::size_t index =
+            (offset - head.base_offset) / options_.segment_capacity;
+        const Segment& seg = *segments_[index];
+        return seg.slots[offset - seg.base_offset];
+    }
+
+    // Returns the consumer group called `name`, creating it positioned at
+    // the earliest retained entry or at the end of the log.
+    ConsumerGroup& group(const std::string& name,
+                         StartFrom from = StartFrom::Earliest) {
+        std::lock_guard<std::mutex> lk(groups_mutex_);
+        auto it = groups_.find(name);
+        if (it == groups_.end()) {
+            const uint64_t start =
+                from == StartFrom::Earliest ? start_offset() : end_offset();
+            it = groups_
+                     .emplace(name, std::unique_ptr<ConsumerGroup>(
+                                        new ConsumerGroup(*this, start)))
+                     .first;
+        }
+        return *it->second;
+    }
+
+    // Applies age-based retention without waiting for the next append.
+    void trim() {
+        std::lock_guard<std::mutex> lk(append_mutex_);
+        enforce_retention(std::chrono::steady_clock::now());
+    }
+
+    void close() noexcept {
+        closed_.store(true, std::memory_order_seq_cst);
+        notify_waiters();
+    }
+
+    bool is_closed() const noexcept { return closed_.load(); }
+
+    uint64_t start_offset() const noexcept {
+        return start_offset_.load(std::memory_order_acquire);
+    }
+    uint64_t end_offset() const noexcept {
+        return end_offset_.load(std::memory_order_acquire);
+    }
+    std::size_t segment_count() const {
+        std::shared_lock<std::shared_mutex> lk(segments_mutex_);
+        return segments_.size();
+    }
+
+    std::pmr::memory_resource* memory_resource() const noexcept {
+        return resource_;
+    }
+
+   private:
+    // A segment and its slot array both live in the log's resource.
+    struct Segment {
+        Segment(std::pmr::memory_resource* r, std::size_t cap)
+            : resource(r), capacity(cap) {
+            void* raw = resource->allocate(capacity * sizeof(std::optional<T>),
+                                           alignof(std::optional<T>));
+            slots = static_cast<std::optional<T>*>(raw);
+            std::uninitialized_default_construct_n(slots, capacity);
+        }
+        ~Segment() {
+            std::destroy_n(slots, capacity);
+            resource->deallocate(slots, capacity * sizeof(std::optional<T>),
+                                 alignof(std::optional<T>));
+        }
+        Segment(const Segment&) = delete;
+        Segment& operator=(const Segment&) = delete;
+
+        std::pmr::memory_resource* const resource;
+        const std::size_t capacity;
+        uint64_t base_offset{0};
+        std::size_t size{0};
+        std::chrono::steady_clock::time_point sealed_at{};
+        std::optional<T>* slots{nullptr};
+    };
+
+    struct SegmentDeleter {
+        void operator()(Segment* seg) const noexcept {
+            std::pmr::memory_resource* resource = seg->resource;
+            seg->~Segment();
+            resource->deallocate(seg, sizeof(Segment), alignof(Segment));
+        }
+    };
+    using SegmentPtr = std::unique_ptr<Segment, SegmentDeleter>;
+
+    SegmentPtr make_segment() {
+        void* raw = resource_->allocate(sizeof(Segment), alignof(Segment));
+        try {
+            return SegmentPtr(
+                new (raw) Segment(resource_, options_.segment_capacity));
+        } catch (...) {
+            resource_->deallocate(raw, sizeof(Segment), alignof(Segment));
+            throw;
+        }
+    }
+
+    SegmentPtr acquire_segment(uint64_t base) {
+        SegmentPtr seg;
+        if (!pool_.empty()) {
+            seg = std::move(pool_.back());
+            pool_.pop_back();
+        } else {
+            seg = make_segment();
+        }
+        seg->base_offset = base;
+        seg->size = 0;
+        return seg;
+    }
+
+    void release_segment(SegmentPtr seg) {
+        if (pool_.size() >= options_.pooled_segments) {
+            return;
+        }
+        for (std::size_t i = 0; i < seg->size; ++i) {
+            seg->slots[i].reset();
+        }
+        pool_.push_back(std::move(seg));
+    }
+
+    template <class U>
+    uint64_t emplace(U&& value) {
+        uint64_t offset;
+        {
+            std::lock_guard<std::mutex> lk(append_mutex_);
+            if (closed_.load(std::memory_order_relaxed)) {
+                throw closed_error("Append after log closed");
+            }
+            offset = end_offset_.load(std::memory_order_relaxed);
+            Segment* tail = segments_.back().get();
+            if (tail->size == options_.segment_capacity) {
+                const auto now = std::chrono::steady_clock::now();
+                tail->sealed_at = now;
+                auto fresh = acquire_segment(offset);
+                tail = fresh.get();
+                {
+                    std::unique_lock<std::shared_mutex> seg_lk(
+                        segments_mutex_);
+                    segments_.push_back(std::move(fresh));
+                }
+                enforce_retention(now);
+            }
+            // Readers never look past end_offset_, so the slot can be filled
+            // without holding the segment list lock.
+            tail->slots[tail->size].emplace(std::forward<U>(value));
+            ++tail->size;
+            end_offset_.store(offset + 1, std::memory_order_seq_cst);
+        }
+        notify_waiters();
+        return offset;
+    }
+
+    // Drops sealed head segments that exceed the size or age limit. Called
+    // with append_mutex_ held.
+    void enforce_retention(std::chrono::steady_clock::time_point now) {
+        std::pmr::vector<SegmentPtr> trimmed(resource_);
+        {
+            std::unique_lock<std::shared_mutex> lk(segments_mutex_);
+            while (segments_.size() > 1) {
+                const Segment& head = *segments_.front();
+                const bool over_size = options_.max_segments != 0 &&
+                                       segments_.size() > options_.max_segments;
+                const bool too_old =
+                    options_.max_age.count() != 0 &&
+                    now - head.sealed_at >= options_.max_age;
+                if (!over_size && !too_old) {
+                    break;
+                }
+                trimmed.push_back(std::move(segments_.front()));
+                segments_.pop_front();
+            }
+            start_offset_.store(segments_.front()->base_offset,
+                                std::memory_order_release);
+        }
+        for (auto& seg : trimmed) {
+            release_segment(std::move(seg));
+        }
+    }
+
+    // Waits until `offset` has been appended. Returns false if the log was
+    // closed first.
+    bool wait_for_offset(uint64_t offset) {
+        auto ready = [&]() {
+            return end_offset_.load(std::memory_order_seq_cst) > offset ||
+                   closed_.load(std::memory_order_seq_cst);
+        };
+        std::unique_lock<std::mutex> lk(wait_mutex_);
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        wait_cv_.wait(lk, ready);
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+        return end_offset_.load(std::memory_order_acquire) > offset;
+    }
+
+    void notify_waiters() {
+        if (waiters_.load(std::memory_order_seq_cst) == 0) {
+            return;
+        }
+        { std::lock_guard<std::mutex> lk(wait_mutex_); }
+        wait_cv_.notify_all();
+    }
+
+    const ReplayLogOptions options_;
+    std::pmr::memory_resource* const resource_;
+
+    std::mutex append_mutex_;
+    mutable std::shared_mutex segments_mutex_;
+    std::pmr::deque<SegmentPtr> segments_;
+    std::pmr::vector<SegmentPtr> pool_;
+
+    std::atomic<uint64_t> start_offset_{0};
+    std::atomic<uint64_t> end_offset_{0};
+    std::atomic<bool> closed_{false};
+
+    std::mutex groups_mutex_;
+    std::map<std::string, std::unique_ptr<ConsumerGroup>> groups_;
+
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+    std::atomic<int> waiters_{0};
+};
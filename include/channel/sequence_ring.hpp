@@ -0,0 +1,236 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Disruptor-style sequenced ring. A single producer claims and publishes
+// sequence numbers; consumer stages each own a cursor and declare which
+// stages they depend on. A stage only sees a slot once every dependency has
+// committed past it, so successive stages work on the same slot in place.
+// The producer is gated by the slowest terminal stage (one nothing else
+// depends on), which keeps it from overwriting unprocessed events.
+//
+// All stages must be added before the first claim. Each stage is meant to be
+// driven by a single thread.
+template <typename T, std::size_t N>
+class SequenceRing {
+    static_assert(N > 0 && (N & (N - 1)) == 0,
+                  "SequenceRing capacity must be a power of two");
+
+   public:
+    static constexpr int64_t kInitialSequence = -1;
+
+    class Stage {
+       public:
+        Stage(const Stage&) = delete;
+        Stage& operator=(const Stage&) = delete;
+
+        // Blocks until `seq` is available to this stage and returns the
+        // highest sequence that can be processed in one batch. Returns
+        // nullopt once the ring is closed and `seq` was never published.
+        std::optional<int64_t> wait_for(int64_t seq) {
+            return ring_.wait_until_available(seq, [&]() {
+                return available();
+            });
+        }
+
+        // Marks everything up to and including `seq` as done, releasing it to
+        // dependent stages (or back to the producer for terminal stages).
+        void commit(int64_t seq) {
+            cursor_.store(seq, std::memory_order_seq_cst);
+            ring_.notify_waiters();
+        }
+
+        // Processes the next available batch in place, calling
+        // handler(T&, int64_t seq) for each slot. Returns false once the ring
+        // is closed and fully drained by this stage.
+        template <class F>
+        bool process(F&& handler) {
+            const int64_t next = cursor_.load(std::memory_order_relaxed) + 1;
+            const auto last = wait_for(next);
+            if (!last.has_value()) {
+                return false;
+            }
+            for (int64_t seq = next; seq <= *last; ++seq) {
+                handler(ring_[seq], seq);
+            }
+            commit(*last);
+            return true;
+        }
+
+        int64_t cursor() const noexcept {
+            return cursor_.load(std::memory_order_acquire);
+        }
+
+       private:
+        friend class SequenceRing;
+
+        Stage(SequenceRing& ring, std::vector<const Stage*> deps)
+            : ring_(ring), deps_(std::move(deps)) {}
+
+        int64_t available() const noexcept {
+            if (deps_.empty()) {
+                return ring_.published_.load(std::memory_order_seq_cst);
+            }
+            int64_t min = std::numeric_limits<int64_t>::max();
+            for (const Stage* dep : deps_) {
+                min = std::min(min,
+                               dep->cursor_.load(std::memory_order_seq_cst));
+            }
+            return min;
+        }
+
+        SequenceRing& ring_;
+        std::vector<const Stage*> deps_;
+        bool terminal_{true};
+        alignas(64) std::atomic<int64_t> cursor_{kInitialSequence};
+    };
+
+    SequenceRing() = default;
+    SequenceRing(const SequenceRing&) = delete;
+    SequenceRing& operator=(const SequenceRing&) = delete;
+
+    // Adds a stage that consumes after every stage in `deps`. With no
+    // dependencies the stage reads directly behind the producer.
+    Stage& add_stage(std::initializer_list<Stage*> deps = {}) {
+        if (claimed_ != kInitialSequence) {
+            throw std::logic_error(
+                "Stages must be added before the first claim");
+        }
+        for (Stage* dep : deps) {
+            if (dep == nullptr || &dep->ring_ != this) {
+                throw std::invalid_argument(
+                    "Stage dependency belongs to another ring");
+            }
+            dep->terminal_ = false;
+        }
+        stages_.emplace_back(new Stage(
+            *this, std::vector<const Stage*>(deps.begin(), deps.end())));
+        return *stages_.back();
+    }
+
+    // Claims the next sequence, waiting while the slot is still held by the
+    // slowest terminal stage. Only the producer thread may call this.
+    int64_t claim() {
+        const int64_t next = claimed_ + 1;
+        const int64_t wrap_point = next - static_cast<int64_t>(N);
+        if (wrap_point > gating_cache_) {
+            wait_until_available(wrap_point, [&]() { return gating_min(); });
+            gating_cache_ = gating_min();
+        }
+        claimed_ = next;
+        return next;
+    }
+
+    // Claims a sequence only if it would not have to wait.
+    std::optional<int64_t> try_claim() {
+        const int64_t next = claimed_ + 1;
+        const int64_t wrap_point = next - static_cast<int64_t>(N);
+        if (wrap_point > gating_cache_) {
+            gating_cache_ = gating_min();
+            if (wrap_point > gating_cache_) {
+                return std::nullopt;
+            }
+        }
+        claimed_ = next;
+        return next;
+    }
+
+    // Makes every claimed sequence up to `seq` visible to the first stages.
+    void publish(int64_t seq) {
+        published_.store(seq, std::memory_order_seq_cst);
+        notify_waiters();
+    }
+
+    // Once closed, stages drain what was published and then stop.
+    void close() noexcept {
+        closed_.store(true, std::memory_order_seq_cst);
+        notify_waiters();
+    }
+
+    bool is_closed() const noexcept { return closed_.load(); }
+
+    T& operator[](int64_t seq) noexcept {
+        return buffer_[static_cast<std::size_t>(seq) & (N - 1)];
+    }
+    const T& operator[](int64_t seq) const noexcept {
+        return buffer_[static_cast<std::size_t>(seq) & (N - 1)];
+    }
+
+    static constexpr std::size_t capacity() noexcept { return N; }
+
+   private:
+    static constexpr int kSpinCount = 128;
+
+    // With no stages nothing holds a slot, so the producer never waits.
+    int64_t gating_min() const noexcept {
+        int64_t min = std::numeric_limits<int64_t>::max();
+        for (const auto& stage : stages_) {
+            if (stage->terminal_) {
+                min = std::min(
+                    min, stage->cursor_.load(std::memory_order_seq_cst));
+            }
+        }
+        return min;
+    }
+
+    // Spins briefly, then parks on the shared condition variable. Returns the
+    // available sequence, or nullopt when closed before `seq` was published.
+    template <class Available>
+    std::optional<int64_t> wait_until_available(int64_t seq,
+                                                Available&& available) {
+        auto ready = [&]() {
+            return available() >= seq ||
+                   (closed_.load(std::memory_order_seq_cst) &&
+                    published_.load(std::memory_order_seq_cst) < seq);
+        };
+        for (int i = 0; i < kSpinCount && !ready(); ++i) {
+            std::this_thread::yield();
+        }
+        if (!ready()) {
+            std::unique_lock<std::mutex> lk(wait_mutex_);
+            waiters_.fetch_add(1, std::memory_order_seq_cst);
+            wait_cv_.wait(lk, ready);
+            waiters_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        const int64_t avail = available();
+        if (avail < seq) {
+            return std::nullopt;
+        }
+        return avail;
+    }
+
+    void notify_waiters() {
+        if (waiters_.load(std::memory_order_seq_cst) == 0) {
+            return;
+        }
+        { std::lock_guard<std::mutex> lk(wait_mutex_); }
+        wait_cv_.notify_all();
+    }
+
+    std::array<T, N> buffer_{};
+    std::vector<std::unique_ptr<Stage>> stages_;
+
+    // Producer-only state.
+    int64_t claimed_{kInitialSequence};
+    int64_t gating_cache_{kInitialSequence};
+
+    alignas(64) std::atomic<int64_t> published_{kInitialSequence};
+    std::atomic<bool> closed_{false};
+
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+    std::atomic<int> waiters_{0};
+};
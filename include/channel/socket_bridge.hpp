@@ -0,0 +1,267 @@
+#pragma once
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <channel/channel.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Default serializer: copies the object representation. Only valid between
+// processes built from the same binary layout, which is the case for a
+// Unix domain socket on one host.
+template <typename T>
+struct TrivialSerializer {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "TrivialSerializer requires a trivially copyable type");
+
+    void serialize(const T& value, std::string& out) const {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    T deserialize(const char* data, std::size_t size) const {
+        if (size != sizeof(T)) {
+            throw std::runtime_error("Frame size does not match payload type");
+        }
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+};
+
+struct SocketBridgeOptions {
+    // Most messages coalesced into one sendmsg call.
+    std::size_t max_batch{64};
+    // Initial size of the receive buffer; grows to fit larger frames.
+    std::size_t receive_buffer{64 * 1024};
+    // Largest payload accepted in either direction. A peer announcing a
+    // larger frame is cut off instead of making the buffer grow to fit it.
+    std::size_t max_frame_size{16 * 1024 * 1024};
+};
+
+// Connects local channels of type Ch (any Channel configuration) to a peer
+// over a connected stream socket (usually AF_UNIX). Each message travels as
+// a frame: a 32-bit length in host byte order followed by the serialized
+// payload.
+//
+// Serializer must provide, for T = Ch::value_type,
+//   void serialize(const T&, std::string& out);   // appends to out
+//   T deserialize(const char* data, std::size_t size);
+//
+// Backpressure runs end to end: when the peer stops reading, sendmsg blocks,
+// send_from stops draining its channel and local producers block on a full
+// Channel. In the other direction receive_into blocks on a full channel and
+// stops reading the socket, which fills the kernel buffer and blocks the
+// peer's sendmsg.
+template <class Ch,
+          class Serializer = TrivialSerializer<typename Ch::value_type>>
+class SocketBridge {
+   public:
+    using value_type = typename Ch::value_type;
+    using FrameLength = uint32_t;
+
+    explicit SocketBridge(int fd, Serializer serializer = {},
+                          SocketBridgeOptions options = {})
+        : fd_(fd), serializer_(std::move(serializer)), options_(options) {
+        if (options_.max_batch == 0 || options_.receive_buffer == 0) {
+            throw std::invalid_argument("Bridge batch and buffer must be set");
+        }
+        if (options_.max_frame_size > UINT32_MAX) {
+            throw std::invalid_argument("max_frame_size exceeds frame limit");
+        }
+    }
+    SocketBridge(const SocketBridge&) = delete;
+    SocketBridge& operator=(const SocketBridge&) = delete;
+
+    // Drains `ch` into the socket until the channel is closed and empty, then
+    // shuts down the write side so the peer sees end of stream. Returns the
+    // number of messages written. If writing fails, `ch` is closed before
+    // the error propagates so blocked producers do not wait forever.
+    std::size_t send_from(Ch& ch) {
+        CloseOnExit guard{ch};
+        std::vector<value_type> batch;
+        batch.reserve(options_.max_batch);
+        std::string wire;
+        std::size_t total = 0;
+        while (true) {
+            batch.clear();
+            if (ch.receive_batch(std::back_inserter(batch),
+                                 options_.max_batch) == 0) {
+                break;
+            }
+            wire.clear();
+            for (const value_type& item : batch) {
+                append_frame(item, wire);
+            }
+            write_all(wire.data(), wire.size());
+            total += batch.size();
+            messages_sent_.fetch_add(batch.size(), std::memory_order_relaxed);
+        }
+        ::shutdown(fd_, SHUT_WR);
+        return total;
+    }
+
+    // Reads frames from the socket into `ch` until the peer shuts down its
+    // write side, then closes `ch`. Returns the number of messages delivered.
+    // If `ch` is closed locally first, reading stops early. `ch` is closed
+    // on errors too.
+    std::size_t receive_into(Ch& ch) {
+        CloseOnExit guard{ch};
+        std::vector<char> buffer(options_.receive_buffer);
+        std::size_t filled = 0;
+        std::vector<value_type> decoded;
+        std::size_t total = 0;
+        while (true) {
+            if (filled == buffer.size()) {
+                // parse_frames() has rejected any frame above the limit, so
+                // this never needs to grow past one maximal frame.
+                buffer.resize(std::min(
+                    buffer.size() * 2,
+                    options_.max_frame_size + sizeof(FrameLength)));
+            }
+            const ssize_t got = read_some(buffer.data() + filled,
+                                          buffer.size() - filled);
+            if (got == 0) {
+                break;
+            }
+            filled += static_cast<std::size_t>(got);
+
+            decoded.clear();
+            const std::size_t consumed =
+                parse_frames(buffer.data(), filled, decoded);
+            if (consumed > 0) {
+                std::memmove(buffer.data(), buffer.data() + consumed,
+                             filled - consumed);
+                filled -= consumed;
+            }
+            if (decoded.empty()) {
+                continue;
+            }
+            try {
+                ch.send_batch(decoded.begin(), decoded.end());
+            } catch (const typename Ch::send_after_close&) {
+                ::shutdown(fd_, SHUT_RD);
+                return total;
+            }
+            total += decoded.size();
+            messages_received_.fetch_add(decoded.size(),
+                                         std::memory_order_relaxed);
+        }
+        if (filled != 0) {
+            throw std::runtime_error("Peer closed mid-frame");
+        }
+        return total;
+    }
+
+    uint64_t messages_sent() const noexcept {
+        return messages_sent_.load(std::memory_order_relaxed);
+    }
+    uint64_t send_calls() const noexcept {
+        return send_calls_.load(std::memory_order_relaxed);
+    }
+    uint64_t messages_received() const noexcept {
+        return messages_received_.load(std::memory_order_relaxed);
+    }
+    uint64_t receive_calls() const noexcept {
+        return receive_calls_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    // Closes a channel on every way out of a bridge loop.
+    struct CloseOnExit {
+        Ch& channel;
+        ~CloseOnExit() { channel.close(); }
+    };
+
+    void append_frame(const value_type& item, std::string& wire) {
+        const std::size_t header_at = wire.size();
+        wire.append(sizeof(FrameLength), '\0');
+        serializer_.serialize(item, wire);
+        const std::size_t payload = wire.size() - header_at -
+                                    sizeof(FrameLength);
+        if (payload > options_.max_frame_size) {
+            throw std::length_error("Serialized message exceeds frame limit");
+        }
+        const FrameLength length = static_cast<FrameLength>(payload);
+        std::memcpy(&wire[header_at], &length, sizeof(length));
+    }
+
+    // Decodes every complete frame in [data, data + size) and returns how
+    // many bytes they used; a trailing partial frame is left for later.
+    // Throws on a frame above max_frame_size, after shutting down reads.
+    std::size_t parse_frames(const char* data, std::size_t size,
+                             std::vector<value_type>& out) {
+        std::size_t pos = 0;
+        while (size - pos >= sizeof(FrameLength)) {
+            FrameLength length;
+            std::memcpy(&length, data + pos, sizeof(length));
+            if (length > options_.max_frame_size) {
+                ::shutdown(fd_, SHUT_RD);
+                throw std::runtime_error("Peer frame exceeds max_frame_size");
+            }
+            if (size - pos - sizeof(FrameLength) < length) {
+                break;
+            }
+            pos += sizeof(FrameLength);
+            out.push_back(serializer_.deserialize(data + pos, length));
+            pos += length;
+        }
+        return pos;
+    }
+
+    void write_all(const char* data, std::size_t size) {
+        while (size > 0) {
+            iovec iov{const_cast<char*>(data), size};
+            msghdr msg{};
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            const ssize_t sent = ::sendmsg(fd_, &msg, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                throw std::system_error(errno, std::generic_category(),
+                                        "sendmsg");
+            }
+            send_calls_.fetch_add(1, std::memory_order_relaxed);
+            data += sent;
+            size -= static_cast<std::size_t>(sent);
+        }
+    }
+
+    ssize_t read_some(char* data, std::size_t size) {
+        while (true) {
+            iovec iov{data, size};
+            msghdr msg{};
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            const ssize_t got = ::recvmsg(fd_, &msg, 0);
+            if (got < 0) {
+                if (errno == EINTR) continue;
+                throw std::system_error(errno, std::generic_category(),
+                                        "recvmsg");
+            }
+            receive_calls_.fetch_add(1, std::memory_order_relaxed);
+            return got;
+        }
+    }
+
+    const int fd_;
+    Serializer serializer_;
+    const SocketBridgeOptions options_;
+
+    std::atomic<uint64_t> messages_sent_{0};
+    std::atomic<uint64_t> send_calls_{0};
+    std::atomic<uint64_t> messages_received_{0};
+    std::atomic<uint64_t> receive_calls_{0};
+};
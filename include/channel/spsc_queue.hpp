@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// Bounded single-producer single-consumer ring. Each side owns one index
+// and keeps a cached copy of the other's, so in steady state a push or pop
+// touches no cache line written by the other thread except the slot itself.
+// Capacity is rounded up to a power of two.
+template <typename T>
+class SpscQueue {
+   public:
+    explicit SpscQueue(std::size_t capacity)
+        : mask_(round_up(capacity) - 1), slots_(new T[mask_ + 1]) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer only. Returns false (leaving `value` untouched) when full.
+    bool try_push(T&& value) {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ > mask_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ > mask_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Moves up to `max` items out, in order, calling fn(T&&)
+    // on each. The head advances before fn runs, so fn may itself pop from
+    // this queue. Returns the number of items consumed.
+    template <class Fn>
+    std::size_t pop_batch(Fn&& fn, std::size_t max) {
+        std::size_t taken = 0;
+        while (taken < max) {
+            const uint64_t head = head_.load(std::memory_order_relaxed);
+            if (head == tail_cache_) {
+                tail_cache_ = tail_.load(std::memory_order_acquire);
+                if (head == tail_cache_) {
+                    break;
+                }
+            }
+            T item = std::move(slots_[head & mask_]);
+            head_.store(head + 1, std::memory_order_release);
+            ++taken;
+            fn(std::move(item));
+        }
+        return taken;
+    }
+
+    // Safe from any thread; exact only when both sides are quiet.
+    bool empty() const noexcept {
+        return head_.load(std::memory_order_acquire) ==
+               tail_.load(std::memory_order_acquire);
+    }
+
+    // Items consumed so far (monotonic).
+    uint64_t popped() const noexcept {
+        return head_.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const noexcept { return mask_ + 1; }
+
+   private:
+    static std::size_t round_up(std::size_t n) {
+        std::size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    const std::size_t mask_;
+    const std::unique_ptr<T[]> slots_;
+
+    alignas(64) std::atomic<uint64_t> head_{0};
+    uint64_t tail_cache_{0};
+    alignas(64) std::atomic<uint64_t> tail_{0};
+    uint64_t head_cache_{0};
+};
@@ -0,0 +1,275 @@
+#pragma once
+
+#include <atomic>
+#include <channel/channel.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct TopicRouterOptions {
+    // Topics whose matched subscriber lists are kept; 0 disables the cache.
+    // The cache is dropped as a whole when it would grow past this.
+    std::size_t max_cached_topics{65536};
+};
+
+// Publish/subscribe over subscriber channels of type Ch, addressed by
+// hierarchical topics made of '/'-separated levels ("site3/dev17/temp").
+// A subscription pattern may use '+' for exactly one level and a final '#'
+// for any number of remaining levels, none included ("site3/#" matches
+// "site3" as well as "site3/dev17/temp").
+//
+// Patterns are compiled into a trie keyed by level, so matching a topic
+// follows its levels instead of testing every subscription. The matched
+// subscriber list is then cached per topic, and a publish to a known topic
+// costs one hash lookup. Subscribing or unsubscribing bumps a generation
+// counter, which invalidates every cached list without touching them.
+//
+// Every matching subscription gets a copy, so a channel subscribed through
+// two overlapping patterns receives the message twice. Delivery uses the
+// blocking sends: a full subscriber channel holds up the publisher, and a
+// closed one is skipped.
+template <class Ch>
+class TopicRouter {
+   public:
+    using value_type = typename Ch::value_type;
+    using Subscriber = std::shared_ptr<Ch>;
+    using SubscriptionId = uint64_t;
+
+    explicit TopicRouter(TopicRouterOptions options = {})
+        : options_(options) {}
+
+    TopicRouter(const TopicRouter&) = delete;
+    TopicRouter& operator=(const TopicRouter&) = delete;
+
+    // Throws std::invalid_argument if a wildcard shares its level with other
+    // characters or '#' is not the last level.
+    SubscriptionId subscribe(std::string_view pattern, Subscriber channel) {
+        if (!channel) {
+            throw std::invalid_argument("Subscriber channel is null");
+        }
+        const auto path = levels(pattern);
+        for (std::size_t i = 0; i < path.size(); ++i) {
+            const std::string_view level = path[i];
+            const bool wildcard = level == "+" || level == "#";
+            if ((!wildcard &&
+                 level.find_first_of("+#") != std::string_view::npos) ||
+                (level == "#" && i + 1 != path.size())) {
+                throw std::invalid_argument("Invalid topic pattern");
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lk(trie_mutex_);
+        Node* node = &root_;
+        for (const std::string_view level : path) {
+            auto& child = node->children[std::string(level)];
+            if (!child) {
+                child = std::make_unique<Node>();
+            }
+            node = child.get();
+        }
+        const SubscriptionId id = next_id_++;
+        node->subscribers.emplace_back(id, std::move(channel));
+        patterns_.emplace(id, std::string(pattern));
+        generation_.fetch_add(1, std::memory_order_release);
+        return id;
+    }
+
+    // Returns false if the subscription does not exist (any more). A publish
+    // that looked up its subscribers before the call may still deliver to
+    // this one.
+    bool unsubscribe(SubscriptionId id) {
+        std::unique_lock<std::shared_mutex> lk(trie_mutex_);
+        const auto found = patterns_.find(id);
+        if (found == patterns_.end()) {
+            return false;
+        }
+        const auto path = levels(found->second);
+        std::vector<Node*> trail{&root_};
+        for (const std::string_view level : path) {
+            trail.push_back(
+                trail.back()->children.find(std::string(level))->second.get());
+        }
+        auto& subs = trail.back()->subscribers;
+        for (auto it = subs.begin(); it != subs.end(); ++it) {
+            if (it->first == id) {
+                subs.erase(it);
+                break;
+            }
+        }
+        // Prune the branch back up to the first node still in use.
+        for (std::size_t i = path.size(); i > 0; --i) {
+            const Node* node = trail[i];
+            if (!node->subscribers.empty() || !node->children.empty()) {
+                break;
+            }
+            trail[i - 1]->children.erase(std::string(path[i - 1]));
+        }
+        patterns_.erase(found);
+        generation_.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+
+    // Sends `message` to every matching subscriber and returns how many got
+    // it. Throws std::invalid_argument if the topic contains a wildcard.
+    std::size_t publish(std::string_view topic, const value_type& message) {
+        const auto targets = subscribers(topic);
+        std::size_t delivered = 0;
+        for (const Subscriber& channel : *targets) {
+            if (channel->is_closed()) {
+                continue;
+            }
+            try {
+                channel->send(message);
+                ++delivered;
+            } catch (const typename Ch::send_after_close&) {
+            }
+        }
+        return delivered;
+    }
+
+    // Like publish(), but hands each subscriber the whole batch through one
+    // send_batch(), copying the messages in as few lock acquisitions as its
+    // free space allows.
+    std::size_t publish_batch(std::string_view topic,
+                              const std::vector<value_type>& messages) {
+        if (messages.empty()) {
+            return 0;
+        }
+        const auto targets = subscribers(topic);
+        std::size_t delivered = 0;
+        for (const Subscriber& channel : *targets) {
+            if (channel->is_closed()) {
+                continue;
+            }
+            try {
+                // Const iterators make send_batch copy instead of move.
+                channel->send_batch(messages.cbegin(), messages.cend());
+                ++delivered;
+            } catch (const typename Ch::send_after_close&) {
+            }
+        }
+        return delivered;
+    }
+
+    std::size_t subscriptions() const {
+        std::shared_lock<std::shared_mutex> lk(trie_mutex_);
+        return patterns_.size();
+    }
+
+   private:
+    using Targets = std::vector<Subscriber>;
+
+    struct Node {
+        // Keyed by level; "+" and "#" are children like any other.
+        std::unordered_map<std::string, std::unique_ptr<Node>> children;
+        std::vector<std::pair<SubscriptionId, Subscriber>> subscribers;
+    };
+
+    struct CacheEntry {
+        uint64_t generation{0};
+        std::shared_ptr<const Targets> targets;
+    };
+
+    static std::vector<std::string_view> levels(std::string_view topic) {
+        std::vector<std::string_view> out;
+        std::size_t begin = 0;
+        while (true) {
+            const std::size_t end = topic.find('/', begin);
+            if (end == std::string_view::npos) {
+                out.push_back(topic.substr(begin));
+                return out;
+            }
+            out.push_back(topic.substr(begin, end - begin));
+            begin = end + 1;
+        }
+    }
+
+    static void append(const Node& node, Targets& out) {
+        for (const auto& sub : node.subscribers) {
+            out.push_back(sub.second);
+        }
+    }
+
+    // Collects the subscribers of every pattern matching path[depth..].
+    static void match(const Node& node,
+                      const std::vector<std::string_view>& path,
+                      std::size_t depth, Targets& out) {
+        const auto& children = node.children;
+        if (const auto rest = children.find("#"); rest != children.end()) {
+            append(*rest->second, out);
+        }
+        if (depth == path.size()) {
+            append(node, out);
+            return;
+        }
+        if (const auto exact = children.find(std::string(path[depth]));
+            exact != children.end()) {
+            match(*exact->second, path, depth + 1, out);
+        }
+        if (const auto one = children.find("+"); one != children.end()) {
+            match(*one->second, path, depth + 1, out);
+        }
+    }
+
+    std::shared_ptr<const Targets> subscribers(std::string_view topic) {
+        const bool caching = options_.max_cached_topics > 0;
+        // Reused across calls so a cache hit does not allocate.
+        thread_local std::string key;
+        if (caching) {
+            key.assign(topic.data(), topic.size());
+            const uint64_t generation =
+                generation_.load(std::memory_order_acquire);
+            std::shared_lock<std::shared_mutex> lk(cache_mutex_);
+            const auto hit = cache_.find(key);
+            if (hit != cache_.end() && hit->second.generation == generation) {
+                return hit->second.targets;
+            }
+        }
+
+        if (topic.find_first_of("+#") != std::string_view::npos) {
+            throw std::invalid_argument("Cannot publish to a wildcard topic");
+        }
+        auto targets = std::make_shared<Targets>();
+        uint64_t generation;
+        {
+            // Changes bump the generation under the exclusive lock, so the
+            // list built here belongs to exactly this generation.
+            std::shared_lock<std::shared_mutex> lk(trie_mutex_);
+            generation = generation_.load(std::memory_order_relaxed);
+            match(root_, levels(topic), 0, *targets);
+        }
+        if (caching) {
+            std::unique_lock<std::shared_mutex> lk(cache_mutex_);
+            auto slot = cache_.find(key);
+            if (slot == cache_.end()) {
+                if (cache_.size() >= options_.max_cached_topics) {
+                    cache_.clear();
+                }
+                slot = cache_.emplace(key, CacheEntry{}).first;
+            }
+            if (slot->second.generation <= generation) {
+                slot->second = CacheEntry{generation, targets};
+            }
+        }
+        return targets;
+    }
+
+    const TopicRouterOptions options_;
+
+    mutable std::shared_mutex trie_mutex_;
+    Node root_;
+    std::unordered_map<SubscriptionId, std::string> patterns_;
+    SubscriptionId next_id_{1};
+    std::atomic<uint64_t> generation_{0};
+
+    std::shared_mutex cache_mutex_;
+    std::unordered_map<std::string, CacheEntry> cache_;
+};
@@ -0,0 +1,252 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ratio>
+#include <thread>
+
+// Cheap monotonic timestamps for hot-path instrumentation. On x86 with an
+// invariant TSC (constant rate, keeps ticking in idle states) now() is one
+// rdtsc plus a fixed-point multiply, converted to nanoseconds with a scale
+// measured against steady_clock the first time the clock is used. Elsewhere
+// it reads CLOCK_MONOTONIC_COARSE, which is as cheap but only advances once
+// per kernel tick (a few milliseconds).
+//
+// A one-off calibration over 10ms is only good to tens of ppm, which would
+// let readings wander off steady_clock without bound. The TSC source is
+// therefore re-anchored against steady_clock at doubling intervals (up to
+// once a second), each time measuring the rate over the whole run so far
+// and slewing towards steady_clock rather than stepping, so readings never
+// go backwards. They share steady_clock's epoch and stay within about ten
+// microseconds of it (the coarse source: within one kernel tick). That is
+// fine for comparing stamps and measuring waits and latencies; timeouts and
+// condition variable deadlines should still be taken from steady_clock.
+class TscClock {
+   public:
+    using rep = int64_t;
+    using period = std::nano;
+    using duration = std::chrono::nanoseconds;
+    using time_point = std::chrono::time_point<TscClock>;
+    static constexpr bool is_steady = true;
+
+    enum class Source { Tsc, MonotonicCoarse };
+
+    static time_point now() noexcept {
+        State& s = state();
+#if defined(__x86_64__) || defined(__i386__)
+        if (s.source == Source::Tsc) {
+            uint64_t tsc = __rdtsc();
+            Anchor anchor = s.load();
+            if (tsc >= anchor.next_ticks) {
+                reanchor(s);
+                tsc = __rdtsc();
+                anchor = s.load();
+            }
+            return time_point(duration(anchor.at(tsc)));
+        }
+#endif
+        timespec ts;
+        ::clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+        return time_point(duration(static_cast<int64_t>(ts.tv_sec) *
+                                       1000000000 +
+                                   ts.tv_nsec));
+    }
+
+    // now() in nanoseconds when it reads the TSC, steady_clock otherwise:
+    // the coarse fallback cannot time anything shorter than a kernel tick.
+    // Same epoch either way.
+    static int64_t precise_ns() noexcept {
+        return source() == Source::Tsc ? now().time_since_epoch().count()
+                                       : steady_ns();
+    }
+
+    // Which source now() reads.
+    static Source source() noexcept { return state().source; }
+
+    // Runs the one-time calibration (about 10ms of sleeping on TSC
+    // machines) now instead of inside the first timed operation.
+    static void calibrate() noexcept { state(); }
+
+   private:
+    // ns = (ticks * ns_per_tick) >> kShift.
+    static constexpr int kShift = 32;
+    // Re-anchoring interval: starts here and doubles up to the maximum.
+    static constexpr int64_t kFirstWindowNs = 10000000;
+    static constexpr int64_t kMaxWindowNs = 1000000000;
+
+    // Maps ticks to nanoseconds: from (ticks, ns) at the slewed slope until
+    // the window ends, then at the measured rate, so a long idle stretch
+    // does not keep applying the correction.
+    struct Anchor {
+        uint64_t ticks{0};
+        int64_t ns{0};
+        int64_t ns_per_tick{0};
+        int64_t rate{0};
+        // When the next re-anchoring is due.
+        uint64_t next_ticks{UINT64_MAX};
+
+        int64_t at(uint64_t tsc) const noexcept {
+            if (tsc <= next_ticks) {
+                return ns + scale(static_cast<int64_t>(tsc - ticks),
+                                  ns_per_tick);
+            }
+            return ns +
+                   scale(static_cast<int64_t>(next_ticks - ticks),
+                         ns_per_tick) +
+                   scale(static_cast<int64_t>(tsc - next_ticks), rate);
+        }
+
+        static int64_t scale(int64_t delta, int64_t per_tick) noexcept {
+            return static_cast<int64_t>(
+                (static_cast<__int128>(delta) * per_tick) >> kShift);
+        }
+    };
+
+    struct State {
+        State() { measure(*this); }
+
+        // Seqlock read of the current anchor.
+        Anchor load() const noexcept {
+            Anchor a;
+            while (true) {
+                const uint32_t before = seq.load(std::memory_order_acquire);
+                a.ticks = ticks.load(std::memory_order_relaxed);
+                a.ns = ns.load(std::memory_order_relaxed);
+                a.ns_per_tick = ns_per_tick.load(std::memory_order_relaxed);
+                a.rate = rate.load(std::memory_order_relaxed);
+                a.next_ticks = next_ticks.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if ((before & 1) == 0 &&
+                    seq.load(std::memory_order_relaxed) == before) {
+                    return a;
+                }
+            }
+        }
+
+        // Only called by the thread holding `anchoring` (or the constructor).
+        void store(const Anchor& a) noexcept {
+            const uint32_t before = seq.load(std::memory_order_relaxed);
+            seq.store(before + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            ticks.store(a.ticks, std::memory_order_relaxed);
+            ns.store(a.ns, std::memory_order_relaxed);
+            ns_per_tick.store(a.ns_per_tick, std::memory_order_relaxed);
+            rate.store(a.rate, std::memory_order_relaxed);
+            next_ticks.store(a.next_ticks, std::memory_order_relaxed);
+            seq.store(before + 2, std::memory_order_release);
+        }
+
+        Source source{Source::MonotonicCoarse};
+        // First calibration sample; rates are measured from here.
+        uint64_t origin_ticks{0};
+        int64_t origin_ns{0};
+        // Guarded by `anchoring`.
+        int64_t window_ns{kFirstWindowNs};
+        std::atomic<bool> anchoring{false};
+        std::atomic<uint32_t> seq{0};
+        std::atomic<uint64_t> ticks{0};
+        std::atomic<int64_t> ns{0};
+        std::atomic<int64_t> ns_per_tick{0};
+        std::atomic<int64_t> rate{0};
+        std::atomic<uint64_t> next_ticks{UINT64_MAX};
+    };
+
+    static State& state() noexcept {
+        static State s;
+        return s;
+    }
+
+    static bool invariant_tsc() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+        // CPUID.80000007H:EDX[8] advertises the invariant TSC.
+        return __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) &&
+               (edx & (1u << 8)) != 0;
+#else
+        return false;
+#endif
+    }
+
+    static int64_t steady_ns() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    // Pairs a steady_clock reading with the TSC midway through it.
+    static void sample(uint64_t& ticks, int64_t& ns) noexcept {
+        const uint64_t before = __rdtsc();
+        ns = steady_ns();
+        ticks = before + (__rdtsc() - before) / 2;
+    }
+
+    static uint64_t window_ticks(int64_t window_ns, int64_t rate) noexcept {
+        return static_cast<uint64_t>(
+            (static_cast<__int128>(window_ns) << kShift) / rate);
+    }
+#endif
+
+    static void measure(State& s) noexcept {
+        if (!invariant_tsc()) {
+            return;
+        }
+#if defined(__x86_64__) || defined(__i386__)
+        uint64_t t0 = 0, t1 = 0;
+        int64_t n0 = 0, n1 = 0;
+        sample(t0, n0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        sample(t1, n1);
+        if (t1 <= t0 || n1 <= n0) {
+            return;
+        }
+        const auto rate = static_cast<int64_t>(
+            (static_cast<__int128>(n1 - n0) << kShift) / (t1 - t0));
+        s.source = Source::Tsc;
+        s.origin_ticks = t0;
+        s.origin_ns = n0;
+        s.store(Anchor{t1, n1, rate, rate,
+                       t1 + window_ticks(s.window_ns, rate)});
+#endif
+    }
+
+    // Starts a new line at the current reading whose slope is the rate
+    // measured since the origin, corrected so that it meets steady_clock
+    // again when the next window ends.
+    static void reanchor(State& s) noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        if (s.anchoring.exchange(true, std::memory_order_acquire)) {
+            return;
+        }
+        const Anchor old = s.load();
+        uint64_t t = 0;
+        int64_t n = 0;
+        sample(t, n);
+        if (t >= old.next_ticks && t > s.origin_ticks && n > s.origin_ns) {
+            const int64_t reading = old.at(t);
+            const auto rate = static_cast<int64_t>(
+                (static_cast<__int128>(n - s.origin_ns) << kShift) /
+                (t - s.origin_ticks));
+            s.window_ns = std::min(s.window_ns * 2, kMaxWindowNs);
+            const uint64_t window = window_ticks(s.window_ns, rate);
+            const auto correction = static_cast<int64_t>(
+                (static_cast<__int128>(n - reading) << kShift) /
+                static_cast<int64_t>(window));
+            const int64_t slope =
+                std::clamp(rate + correction, rate / 2, rate * 2);
+            s.store(Anchor{t, reading, slope, rate, t + window});
+        }
+        s.anchoring.store(false, std::memory_order_release);
+#else
+        (void)s;
+#endif
+    }
+};
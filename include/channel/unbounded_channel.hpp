@@ -0,0 +1,340 @@
+#pragma once
+
+#include <atomic>
+#include <channel/epoch_reclaimer.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+// Unbounded MPMC channel without a shared lock on the data path. Items live
+// in a linked list of fixed-size segments; producers and consumers claim
+// slots with fetch-and-add on per-segment indices (the FAA array queue
+// scheme behind LCRQ/SCQ), so contention is one atomic increment per
+// operation instead of a mutex hand-off. Consumed segments are unlinked and
+// handed to EpochDomain, which frees them once no thread can still be
+// reading them.
+//
+// Consumers only park on a condition variable when the channel looks empty,
+// and producers only touch that mutex when someone is parked. close() has
+// the same meaning as for Channel: sends throw afterwards, receives drain
+// what is left and then return nullopt.
+//
+// Segments come from the memory resource given at construction. Retired
+// segments go back to it whenever EpochDomain gets to them, which can be
+// after the channel is gone, so the resource has to outlive that too (a
+// process-lifetime pool or arena, not one on the channel's stack frame).
+template <typename T, std::size_t SegmentSize = 64>
+class UnboundedChannel {
+    static_assert(SegmentSize > 0, "Segments need at least one slot");
+
+   public:
+    enum class SendResult { Success, Full, Closed };
+    enum class RecvResult { Success, Empty, Closed };
+
+    class send_after_close : public std::runtime_error {
+       public:
+        send_after_close(std::string m) : std::runtime_error(m) {}
+    };
+
+    explicit UnboundedChannel(
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : resource_(resource) {
+        Segment* first = Segment::create(resource_);
+        head_.store(first, std::memory_order_relaxed);
+        tail_.store(first, std::memory_order_relaxed);
+    }
+
+    ~UnboundedChannel() {
+        Segment* seg = head_.load(std::memory_order_relaxed);
+        while (seg != nullptr) {
+            Segment* next = seg->next.load(std::memory_order_relaxed);
+            seg->destroy_ready();
+            Segment::destroy(seg);
+            seg = next;
+        }
+    }
+
+    UnboundedChannel(const UnboundedChannel&) = delete;
+    UnboundedChannel& operator=(const UnboundedChannel&) = delete;
+
+    void send(const T& data) { send_one(data); }
+    void send(T&& data) { send_one(std::move(data)); }
+
+    // Never reports Full; kept for parity with Channel.
+    SendResult try_send(const T& data) {
+        if (!begin_send()) {
+            return SendResult::Closed;
+        }
+        enqueue(data);
+        end_send();
+        return SendResult::Success;
+    }
+
+    std::optional<T> receive() {
+        for (int spin = 0;; ++spin) {
+            if (auto value = dequeue()) {
+                return value;
+            }
+            if (drained()) {
+                return std::nullopt;
+            }
+            if (spin < kSpinCount) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::unique_lock<std::mutex> lk(park_mutex_);
+            sleepers_.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (auto value = dequeue()) {
+                sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                return value;
+            }
+            if (!drained()) {
+                park_cv_.wait(lk);
+            }
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    std::pair<RecvResult, std::optional<T>> try_receive() {
+        if (auto value = dequeue()) {
+            return std::make_pair(RecvResult::Success, std::move(value));
+        }
+        if (drained()) {
+            return std::make_pair(RecvResult::Closed, std::optional<T>{});
+        }
+        return std::make_pair(RecvResult::Empty, std::optional<T>{});
+    }
+
+    void close() noexcept {
+        closed_.store(true, std::memory_order_seq_cst);
+        wake_all();
+    }
+
+    bool is_closed() const noexcept { return closed_.load(); }
+
+    std::pmr::memory_resource* memory_resource() const noexcept {
+        return resource_;
+    }
+
+   private:
+    static constexpr int kSpinCount = 64;
+
+    enum SlotState : uint8_t {
+        kEmpty,
+        kWriting,
+        kReady,
+        kConsumed,
+        // A consumer got here before the producer and gave the slot up, or
+        // the producer's constructor threw. Either way nothing is stored.
+        kSkipped,
+    };
+
+    struct Slot {
+        std::atomic<uint8_t> state{kEmpty};
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* value() noexcept {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+    };
+
+    struct Segment {
+        alignas(64) std::atomic<std::size_t> enq{0};
+        alignas(64) std::atomic<std::size_t> deq{0};
+        alignas(64) std::atomic<Segment*> next{nullptr};
+        // Where this segment came from; reclaim() runs without the channel.
+        std::pmr::memory_resource* resource{nullptr};
+        Slot slots[SegmentSize];
+
+        static Segment* create(std::pmr::memory_resource* resource) {
+            void* raw = resource->allocate(sizeof(Segment), alignof(Segment));
+            Segment* seg = new (raw) Segment();
+            seg->resource = resource;
+            return seg;
+        }
+
+        static void destroy(Segment* seg) noexcept {
+            std::pmr::memory_resource* resource = seg->resource;
+            seg->~Segment();
+            resource->deallocate(seg, sizeof(Segment), alignof(Segment));
+        }
+
+        void destroy_ready() noexcept {
+            for (auto& slot : slots) {
+                if (slot.state.load(std::memory_order_relaxed) == kReady) {
+                    slot.value()->~T();
+                }
+            }
+        }
+
+        static void reclaim(void* ptr) { destroy(static_cast<Segment*>(ptr)); }
+    };
+
+    template <class U>
+    void send_one(U&& data) {
+        if (!begin_send()) {
+            throw send_after_close("Send data after channel closed");
+        }
+        enqueue(std::forward<U>(data));
+        end_send();
+    }
+
+    // Senders announce themselves before checking closed_, so a receiver
+    // that sees the channel closed with no sender in flight knows nothing
+    // else can arrive.
+    bool begin_send() {
+        inflight_senders_.fetch_add(1, std::memory_order_seq_cst);
+        if (closed_.load(std::memory_order_seq_cst)) {
+            end_send();
+            return false;
+        }
+        return true;
+    }
+
+    void end_send() {
+        inflight_senders_.fetch_sub(1, std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_seq_cst) == 0) {
+            return;
+        }
+        if (closed_.load(std::memory_order_relaxed)) {
+            wake_all();
+        } else {
+            { std::lock_guard<std::mutex> lk(park_mutex_); }
+            park_cv_.notify_one();
+        }
+    }
+
+    void wake_all() {
+        { std::lock_guard<std::mutex> lk(park_mutex_); }
+        park_cv_.notify_all();
+    }
+
+    bool drained() {
+        return closed_.load(std::memory_order_seq_cst) &&
+               inflight_senders_.load(std::memory_order_seq_cst) == 0 &&
+               looks_empty();
+    }
+
+    bool looks_empty() {
+        auto guard = EpochDomain::instance().pin();
+        Segment* head = head_.load(std::memory_order_acquire);
+        return head->deq.load(std::memory_order_acquire) >=
+                   head->enq.load(std::memory_order_acquire) &&
+               head->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+    template <class U>
+    void enqueue(U&& data) {
+        auto guard = EpochDomain::instance().pin();
+        while (true) {
+            Segment* tail = tail_.load(std::memory_order_acquire);
+            const std::size_t idx =
+                tail->enq.fetch_add(1, std::memory_order_acq_rel);
+            if (idx < SegmentSize) {
+                Slot& slot = tail->slots[idx];
+                uint8_t expected = kEmpty;
+                if (!slot.state.compare_exchange_strong(
+                        expected, kWriting, std::memory_order_acq_rel)) {
+                    continue;
+                }
+                try {
+                    new (slot.storage) T(std::forward<U>(data));
+                } catch (...) {
+                    slot.state.store(kSkipped, std::memory_order_release);
+                    throw;
+                }
+                slot.state.store(kReady, std::memory_order_release);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                return;
+            }
+
+            // Segment is full: append a new one or help move the tail on.
+            if (tail != tail_.load(std::memory_order_acquire)) {
+                continue;
+            }
+            Segment* next = tail->next.load(std::memory_order_acquire);
+            if (next == nullptr) {
+                Segment* fresh = Segment::create(resource_);
+                if (tail->next.compare_exchange_strong(
+                        next, fresh, std::memory_order_acq_rel)) {
+                    next = fresh;
+                } else {
+                    Segment::destroy(fresh);
+                }
+            }
+            tail_.compare_exchange_strong(tail, next,
+                                          std::memory_order_acq_rel);
+        }
+    }
+
+    std::optional<T> dequeue() {
+        auto guard = EpochDomain::instance().pin();
+        while (true) {
+            Segment* head = head_.load(std::memory_order_acquire);
+            if (head->deq.load(std::memory_order_acquire) >=
+                    head->enq.load(std::memory_order_acquire) &&
+                head->next.load(std::memory_order_acquire) == nullptr) {
+                return std::nullopt;
+            }
+            const std::size_t idx =
+                head->deq.fetch_add(1, std::memory_order_acq_rel);
+            if (idx >= SegmentSize) {
+                Segment* next = head->next.load(std::memory_order_acquire);
+                if (next == nullptr) {
+                    return std::nullopt;
+                }
+                // A producer links a new segment before moving the tail on;
+                // finish that move so the retired segment is unreachable.
+                Segment* stale = head;
+                tail_.compare_exchange_strong(stale, next,
+                                              std::memory_order_acq_rel);
+                if (head_.compare_exchange_strong(head, next,
+                                                  std::memory_order_acq_rel)) {
+                    EpochDomain::instance().retire(head, &Segment::reclaim);
+                }
+                continue;
+            }
+
+            Slot& slot = head->slots[idx];
+            uint8_t state = slot.state.load(std::memory_order_acquire);
+            if (state == kEmpty &&
+                slot.state.compare_exchange_strong(state, kSkipped,
+                                                   std::memory_order_acq_rel)) {
+                // The producer that owns this index has not arrived yet; it
+                // will see kSkipped and retry further on.
+                continue;
+            }
+            while (state == kWriting) {
+                std::this_thread::yield();
+                state = slot.state.load(std::memory_order_acquire);
+            }
+            if (state != kReady) {
+                continue;
+            }
+            std::optional<T> value(std::move(*slot.value()));
+            slot.value()->~T();
+            slot.state.store(kConsumed, std::memory_order_relaxed);
+            return value;
+        }
+    }
+
+    std::pmr::memory_resource* const resource_;
+
+    alignas(64) std::atomic<Segment*> head_{nullptr};
+    alignas(64) std::atomic<Segment*> tail_{nullptr};
+    alignas(64) std::atomic<int> inflight_senders_{0};
+    std::atomic<bool> closed_{false};
+
+    alignas(64) std::atomic<int> sleepers_{0};
+    std::mutex park_mutex_;
+    std::condition_variable park_cv_;
+};
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <channel/adaptive_batcher.hpp>
+#include <channel/channel.hpp>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Test-driven clock for AdaptiveBatchOptions::clock_ns.
+std::atomic<int64_t> fake_ns{1000000000};
+
+int64_t fake_now_ns() { return fake_ns.load(); }
+
+void spin_for(std::chrono::microseconds duration) {
+    const auto until = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < until) {
+    }
+}
+
+}  // namespace
+
+TEST(AdaptiveBatcherTest, GrowsBatchesWhileBehind) {
+    Channel<int, 1024> ch;
+    for (int i = 0; i < 1000; ++i) ch.send(i);
+    ch.close();
+
+    AdaptiveBatchOptions options;
+    options.max_batch = 128;
+    AdaptiveBatcher<Channel<int, 1024>> batcher(ch, options);
+    std::vector<std::size_t> sizes;
+    int expected = 0;
+    while (std::size_t n = batcher.consume([&](std::vector<int>& items) {
+        for (int v : items) EXPECT_EQ(v, expected++);
+    })) {
+        sizes.push_back(n);
+    }
+    EXPECT_EQ(expected, 1000);
+    ASSERT_GE(sizes.size(), 3u);
+    EXPECT_EQ(sizes[0], 1u);
+    EXPECT_EQ(sizes[1], 2u);
+    EXPECT_EQ(sizes[2], 4u);
+    EXPECT_EQ(*std::max_element(sizes.begin(), sizes.end()), 128u);
+}
+
+TEST(AdaptiveBatcherTest, ExpensiveItemsKeepBatchesWithinTarget) {
+    Channel<int, 1024> ch;
+    for (int i = 0; i < 200; ++i) ch.send(i);
+    ch.close();
+
+    AdaptiveBatchOptions options;
+    options.latency_target = std::chrono::milliseconds(2);
+    AdaptiveBatcher<Channel<int, 1024>> batcher(ch, options);
+    std::size_t largest = 0;
+    while (std::size_t n = batcher.consume([](std::vector<int>& items) {
+        spin_for(std::chrono::microseconds(250) * items.size());
+    })) {
+        largest = std::max(largest, n);
+    }
+    // About 2ms / 250us per item.
+    EXPECT_LE(largest, 10u);
+    EXPECT_GE(batcher.item_cost(), std::chrono::microseconds(200));
+}
+
+TEST(AdaptiveBatcherTest, LingersToFillBatchesAtSteadyRate) {
+    // Arrivals every 500us and 10us of handling per item, on a clock the
+    // test advances itself, so the outcome does not depend on scheduling.
+    Channel<int, 1024> ch;
+    AdaptiveBatchOptions options;
+    options.latency_target = std::chrono::milliseconds(20);
+    options.clock_ns = &fake_now_ns;
+    AdaptiveBatcher<Channel<int, 1024>> batcher(ch, options);
+    for (int round = 0; round < 50; ++round) {
+        // Exactly one batch worth arrives, so consume() never lingers.
+        const std::size_t n = batcher.batch_size();
+        for (std::size_t i = 0; i < n; ++i) ch.send(1);
+        fake_ns += static_cast<int64_t>(n) * 500000;
+        ASSERT_EQ(batcher.consume([](std::vector<int>& items) {
+            fake_ns += static_cast<int64_t>(items.size()) * 10000;
+        }),
+                  n);
+    }
+
+    // Just under 2000 items/s against a 20ms budget: about
+    // 20ms / (500us + 10us) = 39 items per batch, lingering for the rest
+    // of the batch to arrive but no longer than the target.
+    EXPECT_GT(batcher.arrival_rate(), 1900.0);
+    EXPECT_LE(batcher.arrival_rate(), 2000.0);
+    EXPECT_EQ(batcher.item_cost(), std::chrono::microseconds(10));
+    EXPECT_GE(batcher.batch_size(), 35u);
+    EXPECT_LE(batcher.batch_size(), 40u);
+    EXPECT_GT(batcher.linger(), std::chrono::milliseconds(15));
+    EXPECT_LE(batcher.linger(), options.latency_target);
+}
@@ -1,11 +1,17 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <atomic>
 #include <channel/channel.hpp>
+#include <channel/counting_resource.hpp>
 #include <chrono>
+#include <ctime>
 #include <iostream>
+#include <iterator>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <set>
 #include <stdexcept>
 #include <thread>
 #include <vector>
@@ -481,3 +487,546 @@ TEST(ChannelCloseTest, SendAfterCloseThrows) {
     int payload = 7;
     EXPECT_THROW(ch.send(payload), std::runtime_error);
 }
+
+TEST(ChannelBatchTest, ReceiveBatchTakesWhatIsBuffered) {
+    Channel<int, 8> ch;
+    std::vector<int> in{1, 2, 3, 4, 5};
+    ch.send_batch(in.begin(), in.end());
+
+    std::vector<int> out;
+    EXPECT_EQ(ch.receive_batch(std::back_inserter(out), 3), 3u);
+    EXPECT_EQ(ch.try_receive_batch(std::back_inserter(out), 8), 2u);
+    EXPECT_EQ(out, in);
+    EXPECT_EQ(ch.try_receive_batch(std::back_inserter(out), 8), 0u);
+}
+
+TEST(ChannelBatchTest, SendBatchLargerThanCapacityBlocksUntilDrained) {
+    Channel<int, 2> ch;
+    std::vector<int> in(50);
+    for (int i = 0; i < 50; ++i) in[i] = i;
+
+    std::thread producer([&]() {
+        ch.send_batch(in.begin(), in.end());
+        ch.close();
+    });
+
+    std::vector<int> out;
+    while (ch.receive_batch(std::back_inserter(out), 4) != 0) {
+    }
+    producer.join();
+    EXPECT_EQ(out, in);
+}
+
+TEST(ChannelBatchTest, ReceiveBatchReturnsZeroOnceClosedAndDrained) {
+    Channel<int, 2> ch;
+    ch.send(1);
+    ch.close();
+
+    std::vector<int> out;
+    EXPECT_EQ(ch.receive_batch(std::back_inserter(out), 4), 1u);
+    EXPECT_EQ(ch.receive_batch(std::back_inserter(out), 4), 0u);
+    EXPECT_THROW(ch.send_batch(out.begin(), out.end()), std::runtime_error);
+}
+
+namespace {
+
+void wait_for_blocked_receivers(const ChannelStats& stats, int n) {
+    while (stats.blocked_receivers.load() < n) {
+        std::this_thread::yield();
+    }
+}
+
+}  // namespace
+
+TEST(ChannelWakePolicyTest, LifoWakesMostRecentlyParkedReceiver) {
+    Channel<int, 4> ch(ChannelOptions{"", WakePolicy::Lifo});
+    std::atomic<int> first_got{-1};
+    std::atomic<int> second_got{-1};
+
+    std::thread first([&]() { first_got.store(ch.receive().value_or(-2)); });
+    wait_for_blocked_receivers(ch.stats(), 1);
+    std::thread second([&]() { second_got.store(ch.receive().value_or(-2)); });
+    wait_for_blocked_receivers(ch.stats(), 2);
+
+    ch.send(10);
+    second.join();
+    EXPECT_EQ(second_got.load(), 10);
+    EXPECT_EQ(first_got.load(), -1);
+
+    ch.send(20);
+    first.join();
+    EXPECT_EQ(first_got.load(), 20);
+}
+
+TEST(ChannelWakePolicyTest, LifoCloseWakesEveryWaiter) {
+    Channel<int, 1> ch(ChannelOptions{"", WakePolicy::Lifo});
+    std::vector<std::thread> receivers;
+    for (int i = 0; i < 3; ++i) {
+        receivers.emplace_back([&]() { EXPECT_FALSE(ch.receive()); });
+    }
+    wait_for_blocked_receivers(ch.stats(), 3);
+    ch.close();
+    for (auto& t : receivers) {
+        t.join();
+    }
+    EXPECT_EQ(ch.stats().blocked_receivers.load(), 0);
+}
+
+TEST(ChannelWakePolicyTest, LifoManyProducersManyConsumers) {
+    constexpr int producers = 4;
+    constexpr int consumers = 4;
+    constexpr int per_producer = 2000;
+    constexpr int total = producers * per_producer;
+    Channel<int, 4> ch(ChannelOptions{"", WakePolicy::Lifo});
+
+    std::vector<std::atomic<int>> counts(total);
+    std::vector<std::thread> threads;
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&]() {
+            std::vector<int> batch;
+            while (ch.receive_batch(std::back_inserter(batch), 3) != 0) {
+                for (int v : batch) counts[v].fetch_add(1);
+                batch.clear();
+            }
+        });
+    }
+    std::vector<std::thread> senders;
+    for (int p = 0; p < producers; ++p) {
+        senders.emplace_back([&, p]() {
+            for (int i = 0; i < per_producer; ++i) {
+                ch.send(p * per_producer + i);
+            }
+        });
+    }
+    for (auto& t : senders) {
+        t.join();
+    }
+    ch.close();
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (int i = 0; i < total; ++i) {
+        ASSERT_EQ(counts[i].load(), 1);
+    }
+}
+
+namespace {
+
+uintptr_t cache_line_of(const void* p) {
+    return reinterpret_cast<uintptr_t>(p) / kChannelCacheLine;
+}
+
+// Pushes values through partially filled rounds so positions wrap around
+// the ring several times, checking FIFO order throughout.
+template <SlotLayout Layout>
+void expect_fifo_across_wraparound() {
+    Channel<int, 64, Layout> ch;
+    int next_in = 0;
+    int next_out = 0;
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < 37; ++i) ch.send(next_in++);
+        while (next_out < next_in) {
+            ASSERT_EQ(ch.receive(), std::optional<int>(next_out++));
+        }
+    }
+}
+
+}  // namespace
+
+TEST(ChannelSlotLayoutTest, EveryLayoutKeepsFifoOrder) {
+    expect_fifo_across_wraparound<SlotLayout::Packed>();
+    expect_fifo_across_wraparound<SlotLayout::Padded>();
+    expect_fifo_across_wraparound<SlotLayout::Scrambled>();
+}
+
+TEST(ChannelSlotLayoutTest, PaddedAndScrambledSeparateNeighbours) {
+    ChannelSlots<int, 64, SlotLayout::Packed> packed;
+    ChannelSlots<int, 64, SlotLayout::Padded> padded;
+    ChannelSlots<int, 64, SlotLayout::Scrambled> scrambled;
+    EXPECT_EQ(cache_line_of(&packed[0]), cache_line_of(&packed[1]));
+    for (int pos = 0; pos + 1 < 64; ++pos) {
+        EXPECT_NE(cache_line_of(&padded[pos]), cache_line_of(&padded[pos + 1]));
+        EXPECT_NE(cache_line_of(&scrambled[pos]),
+                  cache_line_of(&scrambled[pos + 1]));
+    }
+}
+
+TEST(ChannelSlotLayoutTest, ScrambledMapsEveryPositionToItsOwnSlot) {
+    ChannelSlots<int, 64, SlotLayout::Scrambled> slots;
+    std::set<const int*> seen;
+    for (int pos = 0; pos < 64; ++pos) {
+        seen.insert(&slots[pos]);
+    }
+    EXPECT_EQ(seen.size(), 64u);
+
+    // Only one 48-byte slot fits a line, so Scrambled keeps the packed
+    // order.
+    struct Wide {
+        char bytes[48];
+    };
+    ChannelSlots<Wide, 8, SlotLayout::Scrambled> wide;
+    EXPECT_EQ(&wide[1], &wide[0] + 1);
+}
+
+TEST(ChannelSlotLayoutTest, ScrambledManyProducersManyConsumers) {
+    constexpr int producers = 4;
+    constexpr int per_producer = 5000;
+    Channel<int, 32, SlotLayout::Scrambled> ch;
+    std::atomic<long long> sum{0};
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < 4; ++c) {
+        consumers.emplace_back([&]() {
+            while (auto v = ch.receive()) sum.fetch_add(*v);
+        });
+    }
+    std::vector<std::thread> senders;
+    for (int p = 0; p < producers; ++p) {
+        senders.emplace_back([&]() {
+            for (int i = 1; i <= per_producer; ++i) ch.send(i);
+        });
+    }
+    for (auto& t : senders) t.join();
+    ch.close();
+    for (auto& t : consumers) t.join();
+    EXPECT_EQ(sum.load(),
+              static_cast<long long>(producers) * per_producer *
+                  (per_producer + 1) / 2);
+}
+
+TEST(ChannelMemoryResourceTest, StatsAndCodelStateComeFromTheResource) {
+    CountingResource counting;
+    {
+        ChannelOptions options;
+        options.resource = &counting;
+        Channel<int, 8> plain(options);
+        EXPECT_EQ(plain.memory_resource(), &counting);
+        EXPECT_EQ(counting.allocations(), 1u);
+
+        options.codel_target = std::chrono::milliseconds(5);
+        Channel<int, 8> aqm(options);
+        EXPECT_EQ(counting.allocations(), 3u);
+        for (int i = 0; i < 8; ++i) aqm.send(i);
+        for (int i = 0; i < 8; ++i) aqm.receive();
+        EXPECT_EQ(counting.allocations(), 3u);
+    }
+    EXPECT_EQ(counting.deallocations(), 3u);
+    EXPECT_EQ(counting.bytes_in_use(), 0u);
+}
+
+namespace {
+
+ChannelOptions rate_limited(double rate, std::size_t burst) {
+    ChannelOptions options;
+    options.rate = rate;
+    options.burst = burst;
+    return options;
+}
+
+}  // namespace
+
+TEST(ChannelRateLimitTest, BurstIsImmediateThenItemsFollowTheRate) {
+    Channel<int, 16> ch(rate_limited(200.0, 5));
+    for (int i = 0; i < 15; ++i) ch.send(i);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 5; ++i) ASSERT_EQ(ch.receive(), i);
+    const auto burst_done = std::chrono::steady_clock::now();
+    for (int i = 5; i < 15; ++i) ASSERT_EQ(ch.receive(), i);
+    const auto all_done = std::chrono::steady_clock::now();
+
+    EXPECT_LT(burst_done - start, std::chrono::milliseconds(20));
+    // Ten more tokens at 5ms each.
+    EXPECT_GE(all_done - start, std::chrono::milliseconds(45));
+    EXPECT_GT(ch.stats().throttled_ns.load(), 0u);
+}
+
+TEST(ChannelRateLimitTest, BatchesAndTryOperationsRespectTokens) {
+    Channel<int, 16> ch(rate_limited(20.0, 4));
+    for (int i = 0; i < 10; ++i) ch.send(i);
+
+    std::vector<int> out;
+    EXPECT_EQ(ch.receive_batch(std::back_inserter(out), 10), 4u);
+    EXPECT_EQ(ch.try_receive_batch(std::back_inserter(out), 10), 0u);
+    EXPECT_EQ(ch.try_receive().first,
+              (Channel<int, 16>::RecvResult::Empty));
+    EXPECT_EQ(out, (std::vector<int>{0, 1, 2, 3}));
+    EXPECT_EQ(ch.stats().occupancy.load(), 6);
+}
+
+TEST(ChannelRateLimitTest, ConsumersShareOneBucketAndDrainAfterClose) {
+    constexpr int items = 40;
+    Channel<int, 64> ch(rate_limited(400.0, 1));
+    for (int i = 0; i < items; ++i) ch.send(i);
+    ch.close();
+
+    std::atomic<int> received{0};
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < 3; ++c) {
+        consumers.emplace_back([&]() {
+            while (ch.receive()) ++received;
+        });
+    }
+    for (auto& t : consumers) t.join();
+
+    EXPECT_EQ(received.load(), items);
+    // 39 tokens after the first, 2.5ms apart, however many consumers ask.
+    EXPECT_GE(std::chrono::steady_clock::now() - start,
+              std::chrono::microseconds(39 * 2500 - 1000));
+}
+
+TEST(ChannelRateLimitTest, ThrottledReceiverSleepsAfterAnIdlePeriod) {
+    constexpr int items = 200;
+    Channel<int, 256> ch(rate_limited(2000.0, 1));
+    for (int i = 0; i < items; ++i) ch.send(i);
+    // Idle long enough for any clock mismatch between token times and the
+    // wait deadline to exceed the 0.5ms token interval.
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+
+    const std::clock_t cpu_start = std::clock();
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < items; ++i) ASSERT_TRUE(ch.receive());
+    const double wall = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+    const double cpu =
+        static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    // Waiting for tokens must not turn into spinning under the lock.
+    EXPECT_GE(wall, 0.09);
+    EXPECT_LT(cpu, 0.5 * wall);
+}
+
+namespace {
+
+ChannelOptions codel(std::chrono::milliseconds target,
+                     std::chrono::milliseconds interval) {
+    ChannelOptions options;
+    options.codel_target = target;
+    options.codel_interval = interval;
+    return options;
+}
+
+}  // namespace
+
+TEST(ChannelCodelTest, KeepsEverythingWhileConsumersKeepUp) {
+    Channel<int, 8> ch(codel(std::chrono::milliseconds(50),
+                             std::chrono::milliseconds(100)));
+    std::thread producer([&]() {
+        for (int i = 0; i < 20000; ++i) ch.send(i);
+        ch.close();
+    });
+    int expected = 0;
+    while (auto v = ch.receive()) {
+        ASSERT_EQ(*v, expected++);
+    }
+    producer.join();
+    EXPECT_EQ(expected, 20000);
+    EXPECT_EQ(ch.stats().dropped.load(), 0u);
+}
+
+TEST(ChannelCodelTest, DropsFromTheHeadOnceDelayStaysAboveTarget) {
+    // The interval leaves a wide margin around every sleep, and the checks
+    // below hold however many drops the control law has made by then.
+    Channel<int, 16> ch(codel(std::chrono::milliseconds(1),
+                              std::chrono::milliseconds(50)));
+    for (int i = 0; i < 16; ++i) ch.send(i);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    // Above target, but not yet for a whole interval: nothing dropped.
+    EXPECT_EQ(ch.receive(), 0);
+    EXPECT_EQ(ch.stats().dropped.load(), 0u);
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+
+    // A whole interval above target: items go from the head, in order.
+    auto next = ch.receive();
+    ASSERT_TRUE(next);
+    uint64_t dropped = ch.stats().dropped.load();
+    EXPECT_GE(dropped, 1u);
+    EXPECT_EQ(*next, 1 + static_cast<int>(dropped));
+
+    // Draining stays FIFO and the drop count only grows.
+    int last = *next;
+    while (ch.stats().occupancy.load() > 2) {
+        next = ch.receive();
+        ASSERT_TRUE(next);
+        EXPECT_GT(*next, last);
+        last = *next;
+        EXPECT_GE(ch.stats().dropped.load(), dropped);
+        dropped = ch.stats().dropped.load();
+    }
+    EXPECT_EQ(ch.stats().received.load() + ch.stats().dropped.load() +
+                  static_cast<uint64_t>(ch.stats().occupancy.load()),
+              16u);
+
+    // Dropping frees slots for senders.
+    EXPECT_EQ(ch.try_send(100), (Channel<int, 16>::SendResult::Success));
+    EXPECT_EQ(ch.try_send(101), (Channel<int, 16>::SendResult::Success));
+}
+
+TEST(ChannelCodelTest, BoundsQueueingDelayUnderOverload) {
+    using Clock = std::chrono::steady_clock;
+    Channel<Clock::time_point, 64> ch(codel(std::chrono::milliseconds(5),
+                                            std::chrono::milliseconds(20)));
+    std::atomic<bool> stop{false};
+    // Sends about a third more than the consumer takes.
+    std::thread producer([&]() {
+        while (!stop.load()) {
+            ch.send(Clock::now());
+            std::this_thread::sleep_for(std::chrono::microseconds(1500));
+        }
+        ch.close();
+    });
+    std::vector<Clock::duration> delays;
+    const auto until = Clock::now() + std::chrono::milliseconds(1200);
+    while (Clock::now() < until) {
+        if (auto sent = ch.receive()) delays.push_back(Clock::now() - *sent);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    stop = true;
+    while (ch.receive()) {
+    }
+    producer.join();
+
+    // Without AQM the buffer fills within the run and every item then
+    // waits ~64 * 2ms.
+    ASSERT_GT(delays.size(), 100u);
+    std::vector<Clock::duration> tail(delays.end() - 100, delays.end());
+    std::sort(tail.begin(), tail.end());
+    EXPECT_LT(tail[50], std::chrono::milliseconds(40));
+    EXPECT_GT(ch.stats().dropped.load(), 0u);
+}
+
+namespace {
+
+ChannelOptions adaptive_lifo(std::chrono::milliseconds threshold) {
+    ChannelOptions options;
+    options.lifo_after = threshold;
+    return options;
+}
+
+}  // namespace
+
+TEST(ChannelAdaptiveLifoTest, StaysFifoWhileBacklogIsYoung) {
+    Channel<int, 8> ch(adaptive_lifo(std::chrono::seconds(10)));
+    for (int i = 0; i < 5; ++i) ch.send(i);
+    for (int i = 0; i < 5; ++i) EXPECT_EQ(ch.receive(), i);
+    EXPECT_EQ(ch.stats().order_switches.load(), 0u);
+}
+
+TEST(ChannelAdaptiveLifoTest, ServesNewestFirstOnceBacklogGetsOld) {
+    Channel<int, 8> ch(adaptive_lifo(std::chrono::milliseconds(10)));
+    for (int i = 0; i < 5; ++i) ch.send(i);
+    std::this_thread::sleep_for(std::chrono::milliseconds(15));
+
+    EXPECT_EQ(ch.receive(), 4);
+    EXPECT_EQ(ch.receive(), 3);
+    ch.send(5);
+    EXPECT_EQ(ch.receive(), 5);
+    EXPECT_EQ(ch.stats().order_switches.load(), 1u);
+
+    std::vector<int> rest;
+    EXPECT_EQ(ch.receive_batch(std::back_inserter(rest), 8), 3u);
+    EXPECT_EQ(rest, (std::vector<int>{2, 1, 0}));
+    // Emptying the buffer switches back.
+    EXPECT_EQ(ch.stats().order_switches.load(), 2u);
+
+    ch.send(6);
+    ch.send(7);
+    EXPECT_EQ(ch.receive(), 6);
+    EXPECT_EQ(ch.receive(), 7);
+    EXPECT_EQ(ch.stats().order_switches.load(), 2u);
+}
+
+TEST(ChannelBatchTest, ReceiveBatchForLingersUntilFull) {
+    for (WakePolicy policy : {WakePolicy::Broadcast, WakePolicy::Lifo}) {
+        Channel<int, 8> ch(ChannelOptions{"", policy});
+        std::thread producer([&]() {
+            ch.send(1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            for (int i = 2; i <= 4; ++i) ch.send(i);
+        });
+        std::vector<int> out;
+        const auto start = std::chrono::steady_clock::now();
+        EXPECT_EQ(ch.receive_batch_for(std::back_inserter(out), 4,
+                                       std::chrono::seconds(5)),
+                  4u);
+        EXPECT_LT(std::chrono::steady_clock::now() - start,
+                  std::chrono::seconds(1));
+        EXPECT_EQ(out, (std::vector<int>{1, 2, 3, 4}));
+        producer.join();
+    }
+}
+
+TEST(ChannelBatchTest, ReceiveBatchForReturnsPartialBatchAfterLinger) {
+    Channel<int, 8> ch;
+    ch.send(7);
+    std::vector<int> out;
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(ch.receive_batch_for(std::back_inserter(out), 4,
+                                   std::chrono::milliseconds(20)),
+              1u);
+    EXPECT_GE(std::chrono::steady_clock::now() - start,
+              std::chrono::milliseconds(20));
+    ch.close();
+    EXPECT_EQ(ch.receive_batch_for(std::back_inserter(out), 4,
+                                   std::chrono::milliseconds(20)),
+              0u);
+}
+
+TEST(SelectDrainTest, DrainsUpToKFromEveryReadyChannel) {
+    Channel<int, 16> a;
+    Channel<int, 16> b;
+    Channel<int, 16> idle;
+    for (int i = 0; i < 10; ++i) a.send(i);
+    for (int i = 0; i < 2; ++i) b.send(100 + i);
+
+    std::vector<int> from_a, from_b;
+    int from_idle = 0;
+    const std::size_t taken = select_drain(
+        4, drain_case(a, [&](int v) { from_a.push_back(v); }),
+        drain_case(b, [&](int v) { from_b.push_back(v); }),
+        drain_case(idle, [&](int) { ++from_idle; }));
+
+    EXPECT_EQ(taken, 6u);
+    EXPECT_EQ(from_a, (std::vector<int>{0, 1, 2, 3}));
+    EXPECT_EQ(from_b, (std::vector<int>{100, 101}));
+    EXPECT_EQ(from_idle, 0);
+    EXPECT_EQ(select_drain(4, drain_case(idle, [](int) {})), 0u);
+}
+
+TEST(SelectDrainTest, RotatesTheStartingCase) {
+    Channel<int, 64> a;
+    Channel<int, 64> b;
+    for (int i = 0; i < 20; ++i) {
+        a.send(i);
+        b.send(i);
+    }
+    std::vector<char> order;
+    std::set<char> firsts;
+    for (int round = 0; round < 4; ++round) {
+        order.clear();
+        select_drain(1, drain_case(a, [&](int) { order.push_back('a'); }),
+                     drain_case(b, [&](int) { order.push_back('b'); }));
+        ASSERT_EQ(order.size(), 2u);
+        firsts.insert(order.front());
+    }
+    EXPECT_EQ(firsts, (std::set<char>{'a', 'b'}));
+}
+
+TEST(SelectDrainTest, MoveOnlyItemsAndNestedDrains) {
+    Channel<std::unique_ptr<int>, 8> outer;
+    Channel<std::unique_ptr<int>, 8> inner;
+    for (int i = 0; i < 3; ++i) {
+        outer.send(std::make_unique<int>(i));
+        inner.send(std::make_unique<int>(10 + i));
+    }
+    int sum = 0;
+    select_drain(8, drain_case(outer, [&](std::unique_ptr<int> v) {
+                     sum += *v;
+                     select_drain(1, drain_case(inner,
+                                                [&](std::unique_ptr<int> w) {
+                                                    sum += *w;
+                                                }));
+                 }));
+    EXPECT_EQ(sum, 0 + 1 + 2 + 10 + 11 + 12);
+}
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <channel/channel.hpp>
+#include <channel/metrics_exporter.hpp>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+bool registered(const std::string& name) {
+    const auto entries = ChannelRegistry::instance().snapshot();
+    return std::any_of(entries->begin(), entries->end(),
+                       [&](const auto& e) { return e->name == name; });
+}
+
+bool contains(const std::string& haystack, const std::string& needle) {
+    return haystack.find(needle) != std::string::npos;
+}
+
+}  // namespace
+
+TEST(ChannelRegistryTest, NamedChannelsJoinAndLeave) {
+    {
+        Channel<int, 4> named("registry.join");
+        Channel<int, 4> anonymous;
+        EXPECT_TRUE(registered("registry.join"));
+        EXPECT_EQ(named.name(), "registry.join");
+        EXPECT_TRUE(anonymous.name().empty());
+    }
+    EXPECT_FALSE(registered("registry.join"));
+}
+
+TEST(ChannelRegistryTest, SnapshotOutlivesChannel) {
+    auto ch = std::make_unique<Channel<int, 2>>("registry.outlive");
+    ch->send(1);
+    const auto entries = ChannelRegistry::instance().snapshot();
+    ch.reset();
+
+    const auto it = std::find_if(
+        entries->begin(), entries->end(),
+        [](const auto& e) { return e->name == "registry.outlive"; });
+    ASSERT_NE(it, entries->end());
+    EXPECT_EQ((*it)->snapshot().sent, 1u);
+}
+
+TEST(ChannelStatsTest, CountsTrafficOccupancyAndBlockedWaiters) {
+    Channel<int, 2> ch("stats.counts");
+    ch.send(1);
+    ch.send(2);
+    ch.receive();
+
+    auto s = ch.stats().snapshot();
+    EXPECT_EQ(s.sent, 2u);
+    EXPECT_EQ(s.received, 1u);
+    EXPECT_EQ(s.occupancy, 1);
+    EXPECT_EQ(s.capacity, 2u);
+
+    ch.receive();
+    std::thread consumer([&]() { ch.receive(); });
+    while (ch.stats().snapshot().blocked_receivers == 0) {
+        std::this_thread::yield();
+    }
+    ch.send(3);
+    consumer.join();
+
+    s = ch.stats().snapshot();
+    EXPECT_EQ(s.blocked_receivers, 0);
+    EXPECT_EQ(s.occupancy, 0);
+    EXPECT_EQ(s.received, 3u);
+}
+
+TEST(MetricsExporterTest, RendersPrometheusWithRates) {
+    ChannelRegistry registry;
+    auto stats = std::make_shared<ChannelStats>("orders\"in", 8);
+    registry.join(stats);
+
+    MetricsExporter exporter(MetricsExporterOptions{}, registry);
+    exporter.render();
+    stats->sent.store(100);
+    stats->occupancy.store(5);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    const std::string text = exporter.render();
+
+    EXPECT_TRUE(contains(text, "# TYPE channel_sent_total counter"));
+    const std::string label = "{channel=\"orders\\\"in\"} ";
+    EXPECT_TRUE(contains(text, "channel_sent_total" + label + "100"));
+    EXPECT_TRUE(contains(text, "channel_occupancy" + label + "5"));
+    EXPECT_FALSE(contains(text, "channel_send_rate" + label + "0.000000"));
+}
+
+TEST(MetricsExporterTest, WritesJsonToFile) {
+    ChannelRegistry registry;
+    auto stats = std::make_shared<ChannelStats>("json", 4);
+    stats->blocked_senders.store(2);
+    registry.join(stats);
+
+    MetricsExporterOptions options;
+    options.format = MetricsFormat::Json;
+    options.path = ::testing::TempDir() + "channel_metrics.json";
+    MetricsExporter exporter(options, registry);
+    exporter.export_once();
+
+    std::ifstream file(options.path);
+    std::stringstream content;
+    content << file.rdbuf();
+    EXPECT_TRUE(contains(content.str(), "\"name\":\"json\""));
+    EXPECT_TRUE(contains(content.str(), "\"blocked_senders\":2"));
+    std::remove(options.path.c_str());
+}
+
+TEST(MetricsExporterTest, FailedWriteKeepsThePreviousExport) {
+    ChannelRegistry registry;
+    registry.join(std::make_shared<ChannelStats>("full", 1));
+
+    MetricsExporterOptions options;
+    options.path = ::testing::TempDir() + "channel_metrics_full.prom";
+    const std::string tmp = options.path + ".tmp";
+    std::remove(options.path.c_str());
+    std::remove(tmp.c_str());
+    std::ofstream(options.path) << "previous\n";
+    // Every write to /dev/full fails with ENOSPC.
+    ASSERT_EQ(::symlink("/dev/full", tmp.c_str()), 0);
+
+    MetricsExporter exporter(options, registry);
+    EXPECT_THROW(exporter.export_once(), std::runtime_error);
+
+    // Reading /dev/full never ends, so make sure it was not renamed over.
+    struct stat st;
+    ASSERT_EQ(::lstat(options.path.c_str(), &st), 0);
+    ASSERT_TRUE(S_ISREG(st.st_mode));
+    std::ifstream file(options.path);
+    std::stringstream content;
+    content << file.rdbuf();
+    EXPECT_EQ(content.str(), "previous\n");
+    EXPECT_NE(::access(tmp.c_str(), F_OK), 0);
+    std::remove(tmp.c_str());
+    std::remove(options.path.c_str());
+}
+
+TEST(MetricsExporterTest, BackgroundThreadExportsPeriodically) {
+    ChannelRegistry registry;
+    registry.join(std::make_shared<ChannelStats>("periodic", 1));
+
+    MetricsExporterOptions options;
+    options.path = ::testing::TempDir() + "channel_metrics.prom";
+    options.interval = std::chrono::milliseconds(5);
+    std::remove(options.path.c_str());
+    {
+        MetricsExporter exporter(options, registry);
+        exporter.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    }
+
+    std::ifstream file(options.path);
+    ASSERT_TRUE(file.good());
+    std::stringstream content;
+    content << file.rdbuf();
+    EXPECT_TRUE(contains(content.str(), "channel=\"periodic\""));
+    std::remove(options.path.c_str());
+}
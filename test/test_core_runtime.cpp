@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <channel/core_runtime.hpp>
+#include <thread>
+#include <vector>
+
+namespace {
+
+CoreRuntimeOptions unpinned(std::size_t cores) {
+    CoreRuntimeOptions options;
+    options.cores = cores;
+    options.pin = false;
+    options.link_capacity = 16;
+    return options;
+}
+
+}  // namespace
+
+TEST(SpscQueueTest, PushFailsWhenFullAndPopsInOrder) {
+    SpscQueue<int> q(3);
+    EXPECT_EQ(q.capacity(), 4u);
+    for (int i = 0; i < 4; ++i) {
+        int v = i;
+        EXPECT_TRUE(q.try_push(std::move(v)));
+    }
+    int extra = 99;
+    EXPECT_FALSE(q.try_push(std::move(extra)));
+
+    std::vector<int> out;
+    EXPECT_EQ(q.pop_batch([&](int&& v) { out.push_back(v); }, 3), 3u);
+    EXPECT_EQ(out, (std::vector<int>{0, 1, 2}));
+    EXPECT_EQ(q.popped(), 3u);
+    EXPECT_FALSE(q.empty());
+}
+
+TEST(SpscQueueTest, ProducerAndConsumerThreadsKeepOrder) {
+    constexpr int n = 200000;
+    SpscQueue<int> q(64);
+    std::thread producer([&]() {
+        for (int i = 0; i < n; ++i) {
+            int v = i;
+            while (!q.try_push(std::move(v))) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    int expected = 0;
+    bool in_order = true;
+    while (expected < n) {
+        if (q.pop_batch([&](int&& v) { in_order &= v == expected++; },
+                        16) == 0) {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(in_order);
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(CoreRuntimeTest, TasksRunOnTheirTargetCore) {
+    CoreRuntime runtime(unpinned(4));
+    EXPECT_EQ(runtime.cores(), 4u);
+    EXPECT_EQ(CoreRuntime::current_core(), -1);
+
+    std::vector<std::atomic<int>> seen(4);
+    for (int core = 0; core < 4; ++core) {
+        for (int i = 0; i < 100; ++i) {
+            runtime.submit_to(core, [&, core]() {
+                if (CoreRuntime::current_core() == core) seen[core]++;
+            });
+        }
+    }
+    runtime.wait_idle();
+    for (int core = 0; core < 4; ++core) {
+        EXPECT_EQ(seen[core].load(), 100);
+    }
+}
+
+TEST(CoreRuntimeTest, TasksHopAcrossTheMesh) {
+    constexpr int tokens = 64;
+    constexpr int hops = 500;
+    CoreRuntime runtime(unpinned(4));
+    std::atomic<int> finished{0};
+    std::atomic<int> hops_done{0};
+
+    // Each token visits the next core in turn until its hops are used up.
+    std::function<void(int)> hop = [&](int left) {
+        hops_done.fetch_add(1, std::memory_order_relaxed);
+        if (left == 0) {
+            finished.fetch_add(1);
+            return;
+        }
+        const auto next = (CoreRuntime::current_core() + 1) % 4;
+        runtime.submit_to(next, [&hop, left]() { hop(left - 1); });
+    };
+    for (int t = 0; t < tokens; ++t) {
+        runtime.submit_to(t % 4, [&hop]() { hop(hops); });
+    }
+    runtime.wait_idle();
+    EXPECT_EQ(finished.load(), tokens);
+    EXPECT_EQ(hops_done.load(), tokens * (hops + 1));
+}
+
+TEST(CoreRuntimeTest, LinksAreAllocatedOnFirstUse) {
+    CoreRuntime runtime(unpinned(8));
+    EXPECT_EQ(runtime.links(), 0u);
+
+    std::atomic<int> ran{0};
+    runtime.submit_to(0, [&]() {
+        ran.fetch_add(1);
+        runtime.submit_to(1, [&]() { ran.fetch_add(1); });
+        runtime.submit_to(1, [&]() { ran.fetch_add(1); });
+    });
+    runtime.wait_idle();
+    EXPECT_EQ(ran.load(), 3);
+    // The inbox of core 0 and the 0->1 link, out of 8 * 9.
+    EXPECT_EQ(runtime.links(), 2u);
+}
+
+TEST(CoreRuntimeTest, FullLinksDoNotDeadlock) {
+    // Every core floods every other core through 16-slot links; senders
+    // stuck on a full link keep draining their own inbound links.
+    CoreRuntime runtime(unpinned(3));
+    std::atomic<int> ran{0};
+    for (int core = 0; core < 3; ++core) {
+        runtime.submit_to(core, [&]() {
+            for (int i = 0; i < 2000; ++i) {
+                runtime.submit_to(i % 3, [&]() { ran.fetch_add(1); });
+            }
+        });
+    }
+    runtime.wait_idle();
+    EXPECT_EQ(ran.load(), 3 * 2000);
+}
+
+TEST(CoreRuntimeTest, StopFinishesQueuedWork) {
+    std::atomic<int> ran{0};
+    {
+        CoreRuntime runtime(unpinned(2));
+        for (int i = 0; i < 1000; ++i) {
+            runtime.submit_to(i % 2, [&]() {
+                ran.fetch_add(1);
+                runtime.submit_to(0, [&]() { ran.fetch_add(1); });
+            });
+        }
+        runtime.stop();
+        EXPECT_EQ(ran.load(), 2000);
+        EXPECT_THROW(runtime.submit_to(0, []() {}), std::logic_error);
+    }
+    EXPECT_EQ(ran.load(), 2000);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <channel/fair_scheduler.hpp>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(FairSchedulerTest, BackloggedTenantsShareByWeight) {
+    FairScheduler<int, 1024> sched({1, 2, 4}, FairSchedulerOptions{10});
+    for (std::size_t t = 0; t < 3; ++t) {
+        for (int i = 0; i < 500; ++i) {
+            sched.send(t, i);
+        }
+    }
+    // Five full rounds: 10, 20 and 40 items per round.
+    std::vector<std::size_t> served(3, 0);
+    std::vector<int> out;
+    std::size_t total = 0;
+    while (total < 5 * 70) {
+        const auto turn = sched.receive_batch(std::back_inserter(out), 64);
+        ASSERT_GT(turn.count, 0u);
+        served[turn.tenant] += turn.count;
+        total += turn.count;
+    }
+    EXPECT_EQ(served, (std::vector<std::size_t>{50, 100, 200}));
+}
+
+TEST(FairSchedulerTest, QuietTenantIsNotStarvedByNoisyOne) {
+    FairScheduler<int, 1024> sched({1, 1}, FairSchedulerOptions{8});
+    for (int i = 0; i < 1000; ++i) {
+        sched.send(0, i);
+    }
+    std::vector<int> out;
+    // The noisy tenant's first turn is already under way.
+    auto turn = sched.receive_batch(std::back_inserter(out), 3);
+    EXPECT_EQ(turn.tenant, 0u);
+    sched.send(1, 42);
+
+    std::size_t noisy_before_quiet = turn.count;
+    while (true) {
+        turn = sched.receive_batch(std::back_inserter(out), 64);
+        if (turn.tenant == 1) break;
+        noisy_before_quiet += turn.count;
+    }
+    EXPECT_EQ(turn.count, 1u);
+    EXPECT_EQ(out.back(), 42);
+    EXPECT_EQ(noisy_before_quiet, 8u);
+}
+
+TEST(FairSchedulerTest, BatchLimitSplitsATurnWithoutLosingPlace) {
+    FairScheduler<int, 64> sched({1, 1}, FairSchedulerOptions{8});
+    for (int i = 0; i < 20; ++i) {
+        sched.send(0, i);
+        sched.send(1, 100 + i);
+    }
+    std::vector<int> out;
+    std::vector<std::size_t> counts;
+    std::vector<std::size_t> tenants;
+    for (int i = 0; i < 6; ++i) {
+        const auto turn = sched.receive_batch(std::back_inserter(out), 3);
+        counts.push_back(turn.count);
+        tenants.push_back(turn.tenant);
+    }
+    EXPECT_EQ(counts, (std::vector<std::size_t>{3, 3, 2, 3, 3, 2}));
+    EXPECT_EQ(tenants, (std::vector<std::size_t>{0, 0, 0, 1, 1, 1}));
+    EXPECT_EQ(out.front(), 0);
+    EXPECT_EQ(out[8], 100);
+}
+
+TEST(FairSchedulerTest, ZeroBatchLimitIsRejected) {
+    FairScheduler<int, 8> sched({1});
+    sched.send(0, 1);
+    std::vector<int> out;
+    EXPECT_THROW(sched.receive_batch(std::back_inserter(out), 0),
+                 std::invalid_argument);
+    // The scheduler is left untouched.
+    const auto turn = sched.receive_batch(std::back_inserter(out), 4);
+    EXPECT_EQ(turn.count, 1u);
+    EXPECT_EQ(out, std::vector<int>{1});
+}
+
+TEST(FairSchedulerTest, ConcurrentProducersAndConsumersDeliverEverything) {
+    constexpr std::size_t tenants = 16;
+    constexpr int per_tenant = 2000;
+    FairScheduler<int, 8> sched(std::vector<std::size_t>(tenants, 1),
+                                FairSchedulerOptions{4});
+    std::atomic<long> sum{0};
+    std::atomic<std::size_t> items{0};
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < 3; ++c) {
+        consumers.emplace_back([&]() {
+            std::vector<int> out;
+            while (true) {
+                out.clear();
+                const auto turn =
+                    sched.receive_batch(std::back_inserter(out), 16);
+                if (turn.count == 0) break;
+                for (int v : out) sum += v;
+                items += turn.count;
+            }
+        });
+    }
+    std::vector<std::thread> producers;
+    for (std::size_t p = 0; p < 4; ++p) {
+        producers.emplace_back([&, p]() {
+            for (std::size_t t = p; t < tenants; t += 4) {
+                for (int i = 1; i <= per_tenant; ++i) {
+                    sched.send(t, i);
+                }
+            }
+        });
+    }
+    for (auto& t : producers) t.join();
+    sched.close();
+    for (auto& t : consumers) t.join();
+
+    EXPECT_EQ(items.load(), tenants * per_tenant);
+    EXPECT_EQ(sum.load(),
+              static_cast<long>(tenants) * per_tenant * (per_tenant + 1) / 2);
+    for (std::size_t t = 0; t < tenants; ++t) {
+        EXPECT_EQ(sched.stats(t).occupancy.load(), 0);
+    }
+}
@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <channel/fd_bridge.hpp>
+#include <csignal>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Pipe {
+    int fds[2]{-1, -1};
+
+    Pipe() {
+        if (::pipe(fds) != 0) {
+            throw std::system_error(errno, std::generic_category(), "pipe");
+        }
+    }
+    ~Pipe() {
+        if (fds[0] >= 0) ::close(fds[0]);
+        if (fds[1] >= 0) ::close(fds[1]);
+    }
+    void close_read() {
+        ::close(fds[0]);
+        fds[0] = -1;
+    }
+    void close_write() {
+        ::close(fds[1]);
+        fds[1] = -1;
+    }
+};
+
+struct TempFile {
+    char path[32] = "/tmp/fd_bridge_XXXXXX";
+    int fd{-1};
+
+    TempFile() {
+        fd = ::mkstemp(path);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "mkstemp");
+        }
+    }
+    ~TempFile() {
+        ::close(fd);
+        ::unlink(path);
+    }
+
+    std::string contents() const {
+        std::string out;
+        char chunk[4096];
+        off_t offset = 0;
+        ssize_t got;
+        while ((got = ::pread(fd, chunk, sizeof(chunk), offset)) > 0) {
+            out.append(chunk, static_cast<std::size_t>(got));
+            offset += got;
+        }
+        return out;
+    }
+};
+
+char pattern(std::size_t i) { return static_cast<char>('a' + i % 23); }
+
+// Sends buffers of the given sizes, filled with pattern() over the whole
+// stream, and closes the channel. Returns the expected byte stream.
+template <int N>
+std::string produce(Channel<PageBuffer, N>& ch,
+                    const std::vector<std::size_t>& sizes) {
+    std::string expected;
+    for (std::size_t size : sizes) {
+        PageBuffer buf(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            buf.data()[i] = pattern(expected.size() + i);
+        }
+        buf.resize(size);
+        expected.append(buf.data(), size);
+        ch.send(std::move(buf));
+    }
+    ch.close();
+    return expected;
+}
+
+std::string read_all(int fd) {
+    std::string out;
+    char chunk[65536];
+    ssize_t got;
+    while ((got = ::read(fd, chunk, sizeof(chunk))) > 0) {
+        out.append(chunk, static_cast<std::size_t>(got));
+    }
+    return out;
+}
+
+}  // namespace
+
+TEST(FdBridgeTest, PageBufferIsPageAlignedAndMoveOnly) {
+    PageBuffer buf(100);
+    EXPECT_EQ(buf.capacity(), PageBuffer::page_size());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(buf.data()) %
+                  PageBuffer::page_size(),
+              0u);
+    EXPECT_EQ(buf.append("hello", 5), 5u);
+    EXPECT_THROW(buf.resize(buf.capacity() + 1), std::length_error);
+
+    PageBuffer moved(std::move(buf));
+    EXPECT_EQ(buf.data(), nullptr);
+    EXPECT_EQ(std::string(moved.data(), moved.size()), "hello");
+}
+
+TEST(FdBridgeTest, SplicesIntoPipeWithoutCopying) {
+    Pipe pipe;
+    Channel<PageBuffer, 8> ch;
+    FdBridge<8> bridge(pipe.fds[1], {FdBridgeMode::Splice, 4});
+
+    std::string received;
+    std::thread reader([&]() { received = read_all(pipe.fds[0]); });
+
+    std::vector<std::size_t> sizes(64, 64 * 1024);
+    std::string expected;
+    std::thread producer([&]() { expected = produce(ch, sizes); });
+
+    const std::size_t written = bridge.drain(ch);
+    pipe.close_write();
+    producer.join();
+    reader.join();
+
+    EXPECT_EQ(written, expected.size());
+    EXPECT_EQ(received, expected);
+    EXPECT_EQ(bridge.bytes_spliced(), expected.size());
+    EXPECT_EQ(bridge.bytes_copied(), 0u);
+}
+
+TEST(FdBridgeTest, SplicesIntoFileThroughInternalPipe) {
+    TempFile file;
+    Channel<PageBuffer, 8> ch;
+    FdBridge<8> bridge(file.fd);
+
+    // Odd sizes leave partial pages at the end of most buffers.
+    const std::vector<std::size_t> sizes{1, 4095, 4096, 4097, 0, 100000, 7};
+    const std::string expected = produce(ch, sizes);
+    const std::size_t written = bridge.drain(ch);
+
+    EXPECT_EQ(written, expected.size());
+    EXPECT_EQ(file.contents(), expected);
+    EXPECT_EQ(bridge.mode(), FdBridgeMode::Splice);
+    EXPECT_EQ(bridge.bytes_spliced(), expected.size());
+}
+
+TEST(FdBridgeTest, WritevModeCopiesInBatches) {
+    TempFile file;
+    Channel<PageBuffer, 16> ch;
+    FdBridge<16> bridge(file.fd, {FdBridgeMode::Writev, 16});
+
+    const std::vector<std::size_t> sizes(16, 1000);
+    const std::string expected = produce(ch, sizes);
+    bridge.drain(ch);
+
+    EXPECT_EQ(file.contents(), expected);
+    EXPECT_EQ(bridge.bytes_copied(), expected.size());
+    EXPECT_EQ(bridge.bytes_spliced(), 0u);
+    // All sixteen buffers were queued before the drain, so one batch and
+    // one writev suffice.
+    EXPECT_EQ(bridge.syscalls(), 1u);
+}
+
+TEST(FdBridgeTest, ReaderHangingUpFailsTheDrainAndReleasesProducers) {
+    // Let the write fail with EPIPE instead of killing the test.
+    std::signal(SIGPIPE, SIG_IGN);
+    Pipe pipe;
+    Channel<PageBuffer, 4> ch;
+    FdBridge<4> bridge(pipe.fds[1]);
+
+    // Far more than the pipe and the channel hold together, so the
+    // producer is still blocked in send when the drain fails.
+    std::atomic<bool> released{false};
+    std::thread producer([&]() {
+        try {
+            for (int i = 0; i < 1000; ++i) {
+                PageBuffer buf(4096);
+                buf.resize(4096);
+                ch.send(std::move(buf));
+            }
+        } catch (const std::runtime_error&) {
+            released = true;
+        }
+    });
+    std::thread reader([&]() {
+        char chunk[4096];
+        std::size_t got = 0;
+        while (got < sizeof(chunk)) {
+            const ssize_t n = ::read(pipe.fds[0], chunk, sizeof(chunk) - got);
+            if (n <= 0) break;
+            got += static_cast<std::size_t>(n);
+        }
+        pipe.close_read();
+    });
+
+    EXPECT_THROW(bridge.drain(ch), std::system_error);
+    reader.join();
+    producer.join();
+    EXPECT_TRUE(released.load());
+    EXPECT_TRUE(ch.is_closed());
+}
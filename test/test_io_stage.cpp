@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <channel/io_stage.hpp>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct TempFile {
+    char path[32] = "/tmp/io_stage_XXXXXX";
+    int fd{-1};
+
+    TempFile() {
+        fd = ::mkstemp(path);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "mkstemp");
+        }
+    }
+    ~TempFile() {
+        ::close(fd);
+        ::unlink(path);
+    }
+
+    std::string read_at(off_t offset, std::size_t size) const {
+        std::string out(size, '\0');
+        const ssize_t got = ::pread(fd, out.data(), size, offset);
+        out.resize(got < 0 ? 0 : static_cast<std::size_t>(got));
+        return out;
+    }
+};
+
+using Stage = IoStage<Channel<IoRequest, 64>, Channel<IoCompletion, 64>>;
+
+class IoStageTest : public ::testing::TestWithParam<IoBackend> {
+   protected:
+    // Skips the io_uring run when the kernel (or a seccomp filter) refuses
+    // io_uring_setup.
+    std::unique_ptr<Stage> make_stage() {
+        IoStageOptions options;
+        options.backend = GetParam();
+        try {
+            return std::make_unique<Stage>(options);
+        } catch (const std::system_error&) {
+            return nullptr;
+        }
+    }
+
+    // Runs the stage over `requests` and collects every completion.
+    std::vector<IoCompletion> run(Stage& stage,
+                                  std::vector<IoRequest> requests) {
+        Channel<IoRequest, 64> in;
+        Channel<IoCompletion, 64> out;
+        std::thread worker([&]() { stage.run(in, out); });
+        std::thread producer([&]() {
+            for (auto& request : requests) {
+                in.send(std::move(request));
+            }
+            in.close();
+        });
+        std::vector<IoCompletion> completions;
+        while (auto completion = out.receive()) {
+            completions.push_back(*completion);
+        }
+        producer.join();
+        worker.join();
+        return completions;
+    }
+};
+
+}  // namespace
+
+TEST_P(IoStageTest, WritesLandAtTheirOffsets) {
+    auto stage = make_stage();
+    if (!stage) GTEST_SKIP() << "io_uring is not available";
+    EXPECT_EQ(stage->backend(), GetParam());
+
+    constexpr int n = 500;
+    constexpr int64_t block = 512;
+    TempFile file;
+    std::vector<IoRequest> requests;
+    for (int i = 0; i < n; ++i) {
+        requests.push_back(IoRequest{IoOp::Write, file.fd, i * block,
+                                     std::string(block, 'a' + i % 26),
+                                     static_cast<uint64_t>(i)});
+    }
+
+    const auto completions = run(*stage, std::move(requests));
+    ASSERT_EQ(completions.size(), static_cast<std::size_t>(n));
+    std::vector<bool> seen(n, false);
+    for (const auto& c : completions) {
+        EXPECT_EQ(c.result, block);
+        seen[c.user_data] = true;
+    }
+    for (int i = 0; i < n; ++i) {
+        EXPECT_TRUE(seen[i]);
+        EXPECT_EQ(file.read_at(i * block, block),
+                  std::string(block, 'a' + i % 26));
+    }
+}
+
+TEST_P(IoStageTest, FsyncCompletesAfterEveryEarlierWrite) {
+    auto stage = make_stage();
+    if (!stage) GTEST_SKIP() << "io_uring is not available";
+
+    TempFile file;
+    std::vector<IoRequest> requests;
+    for (int round = 0; round < 4; ++round) {
+        for (int i = 0; i < 20; ++i) {
+            const int id = round * 100 + i;
+            requests.push_back(IoRequest{IoOp::Write, file.fd,
+                                         int64_t{id} * 64,
+                                         std::string(64, 'x'),
+                                         static_cast<uint64_t>(id)});
+        }
+        requests.push_back(IoRequest{IoOp::Fsync, file.fd, 0, {},
+                                     static_cast<uint64_t>(round * 100 + 99)});
+    }
+
+    const auto completions = run(*stage, std::move(requests));
+    ASSERT_EQ(completions.size(), 84u);
+    // Every write of a round completes before that round's fsync, and no
+    // write of a later round completes before it.
+    for (std::size_t pos = 0; pos < completions.size(); ++pos) {
+        const auto& c = completions[pos];
+        const uint64_t round = c.user_data / 100;
+        if (c.op == IoOp::Fsync) {
+            EXPECT_EQ(c.result, 0);
+            EXPECT_EQ(pos, round * 21 + 20);
+        } else {
+            EXPECT_GE(pos, round * 21);
+            EXPECT_LT(pos, round * 21 + 20);
+        }
+    }
+}
+
+TEST_P(IoStageTest, ErrorsComeBackAsNegativeErrno) {
+    auto stage = make_stage();
+    if (!stage) GTEST_SKIP() << "io_uring is not available";
+
+    std::vector<IoRequest> requests;
+    requests.push_back(IoRequest{IoOp::Write, -1, 0, "data", 1});
+    requests.push_back(IoRequest{IoOp::Fsync, -1, 0, {}, 2});
+    const auto completions = run(*stage, std::move(requests));
+    ASSERT_EQ(completions.size(), 2u);
+    for (const auto& c : completions) {
+        EXPECT_EQ(c.result, -EBADF);
+    }
+}
+
+TEST_P(IoStageTest, StreamWritesReachAPipe) {
+    auto stage = make_stage();
+    if (!stage) GTEST_SKIP() << "io_uring is not available";
+
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    std::vector<IoRequest> requests;
+    requests.push_back(IoRequest{IoOp::Write, fds[1], -1, "hello", 7});
+    const auto completions = run(*stage, std::move(requests));
+    ::close(fds[1]);
+
+    ASSERT_EQ(completions.size(), 1u);
+    EXPECT_EQ(completions[0].result, 5);
+    EXPECT_EQ(completions[0].user_data, 7u);
+    char buf[8] = {};
+    EXPECT_EQ(::read(fds[0], buf, sizeof(buf)), 5);
+    EXPECT_STREQ(buf, "hello");
+    ::close(fds[0]);
+}
+
+TEST_P(IoStageTest, ClosedCompletionsStopTheStageAndReleaseProducers) {
+    auto stage = make_stage();
+    if (!stage) GTEST_SKIP() << "io_uring is not available";
+
+    TempFile file;
+    Channel<IoRequest, 64> in;
+    Channel<IoCompletion, 64> out;
+    out.close();
+    // Far more than the stage can take before its first completion fails,
+    // so the producer is still blocked in send when the stage gives up.
+    std::atomic<bool> released{false};
+    std::thread producer([&]() {
+        try {
+            for (int i = 0; i < 10000; ++i) {
+                in.send(IoRequest{IoOp::Write, file.fd, int64_t{i} * 64,
+                                  std::string(64, 'x'),
+                                  static_cast<uint64_t>(i)});
+            }
+        } catch (const std::runtime_error&) {
+            released = true;
+        }
+    });
+    EXPECT_THROW(stage->run(in, out), std::runtime_error);
+    producer.join();
+    EXPECT_TRUE(released.load());
+    EXPECT_TRUE(in.is_closed());
+}
+
+TEST(IoStageChannelsTest, RunsOverOtherChannelTypes) {
+    using Requests = Channel<IoRequest, 2, SlotLayout::Padded>;
+    using Completions = Channel<IoCompletion, 1, SlotLayout::Packed, PiMutex>;
+    IoStageOptions options;
+    options.backend = IoBackend::ThreadPool;
+    IoStage<Requests, Completions> stage(options);
+
+    TempFile file;
+    Requests in;
+    Completions out;
+    std::thread worker([&]() { stage.run(in, out); });
+    for (int i = 0; i < 10; ++i) {
+        in.send(IoRequest{IoOp::Write, file.fd, int64_t{i} * 4, "abcd",
+                          static_cast<uint64_t>(i)});
+    }
+    in.close();
+    int completed = 0;
+    while (auto completion = out.receive()) {
+        EXPECT_EQ(completion->result, 4);
+        ++completed;
+    }
+    worker.join();
+    EXPECT_EQ(completed, 10);
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, IoStageTest,
+                         ::testing::Values(IoBackend::IoUring,
+                                           IoBackend::ThreadPool));
@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <atomic>
+#include <channel/channel.hpp>
+#include <channel/pi_mutex.hpp>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+bool set_fifo(int priority) {
+    sched_param param{};
+    param.sched_priority = priority;
+    return ::pthread_setschedparam(::pthread_self(), SCHED_FIFO, &param) == 0;
+}
+
+bool pin_to_first_cpu() {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (::sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return false;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed)) {
+            cpu_set_t one;
+            CPU_ZERO(&one);
+            CPU_SET(cpu, &one);
+            return ::pthread_setaffinity_np(::pthread_self(), sizeof(one),
+                                            &one) == 0;
+        }
+    }
+    return false;
+}
+
+void spin_for(std::chrono::milliseconds duration) {
+    const auto until = Clock::now() + duration;
+    while (Clock::now() < until) {
+    }
+}
+
+// Payload whose copy burns CPU, so a sender holds the channel lock for a
+// long, preemptible stretch.
+struct SlowCopy {
+    std::atomic<bool>* copying{nullptr};
+    std::chrono::milliseconds cost{0};
+
+    SlowCopy() = default;
+    SlowCopy(std::atomic<bool>* flag, std::chrono::milliseconds c)
+        : copying(flag), cost(c) {}
+    SlowCopy(const SlowCopy& other) = default;
+    SlowCopy& operator=(const SlowCopy& other) {
+        copying = other.copying;
+        cost = other.cost;
+        if (copying != nullptr) {
+            copying->store(true);
+        }
+        spin_for(cost);
+        return *this;
+    }
+};
+
+// Classic inversion on a single CPU: a low-priority sender is inside the
+// channel lock, a medium-priority thread hogs the CPU, and a high-priority
+// sender needs the lock. Returns how long the high-priority send took, or
+// a negative value when real-time priorities are not available.
+template <class Mutex>
+std::chrono::milliseconds high_priority_send_time() {
+    std::chrono::milliseconds waited{-1};
+    std::thread coordinator([&]() {
+        // Highest of the four, so it can set the scene before anyone else
+        // runs. Threads inherit its CPU and policy.
+        if (!pin_to_first_cpu() || !set_fifo(40)) {
+            return;
+        }
+        Channel<SlowCopy, 4, SlotLayout::Packed, Mutex> ch;
+        std::atomic<bool> copying{false};
+        std::thread low([&]() {
+            set_fifo(10);
+            ch.send(SlowCopy(&copying, std::chrono::milliseconds(50)));
+        });
+        while (!copying.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::thread medium([]() {
+            set_fifo(20);
+            spin_for(std::chrono::milliseconds(400));
+        });
+        std::thread high([&]() {
+            set_fifo(30);
+            const auto start = Clock::now();
+            ch.send(SlowCopy());
+            waited = std::chrono::duration_cast<std::chrono::milliseconds>(
+                Clock::now() - start);
+        });
+        high.join();
+        medium.join();
+        low.join();
+    });
+    coordinator.join();
+    return waited;
+}
+
+}  // namespace
+
+TEST(PiMutexTest, LocksAndWaitsLikeAStandardMutex) {
+    PiMutex mutex;
+    PiConditionVariable cv;
+    bool ready = false;
+
+    ASSERT_TRUE(mutex.try_lock());
+    mutex.unlock();
+
+    std::thread signaler([&]() {
+        std::lock_guard<PiMutex> lk(mutex);
+        ready = true;
+        cv.notify_one();
+    });
+    {
+        std::unique_lock<PiMutex> lk(mutex);
+        cv.wait(lk, [&]() { return ready; });
+        EXPECT_TRUE(ready);
+    }
+    signaler.join();
+}
+
+TEST(PiMutexTest, ChannelDeliversEverythingUnderBothWakePolicies) {
+    for (WakePolicy policy : {WakePolicy::Broadcast, WakePolicy::Lifo}) {
+        Channel<int, 4, SlotLayout::Packed, PiMutex> ch(
+            ChannelOptions{"", policy});
+        constexpr int per_producer = 5000;
+        std::atomic<long> sum{0};
+        std::vector<std::thread> consumers;
+        for (int c = 0; c < 3; ++c) {
+            consumers.emplace_back([&]() {
+                while (auto v = ch.receive()) {
+                    sum += *v;
+                }
+            });
+        }
+        std::vector<std::thread> producers;
+        for (int p = 0; p < 3; ++p) {
+            producers.emplace_back([&]() {
+                for (int i = 1; i <= per_producer; ++i) {
+                    ch.send(i);
+                }
+            });
+        }
+        for (auto& t : producers) t.join();
+        ch.close();
+        for (auto& t : consumers) t.join();
+        EXPECT_EQ(sum.load(), 3L * per_producer * (per_producer + 1) / 2);
+    }
+}
+
+TEST(PiMutexTest, BoundsHighPriorityWaitUnderInversion) {
+    const auto plain = high_priority_send_time<std::mutex>();
+    if (plain.count() < 0) {
+        GTEST_SKIP() << "SCHED_FIFO or CPU pinning not permitted";
+    }
+    const auto inherited = high_priority_send_time<PiMutex>();
+    ASSERT_GE(inherited.count(), 0);
+
+    // Without inheritance the medium thread runs first (~400ms); with it
+    // the lock owner is boosted and only finishes its 50ms copy.
+    EXPECT_LT(inherited.count(), 200);
+    EXPECT_GT(plain.count(), inherited.count());
+}
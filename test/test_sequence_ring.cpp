@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <channel/sequence_ring.hpp>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Event {
+    int64_t raw{0};
+    int64_t decoded{0};
+    int64_t enriched{0};
+};
+
+}  // namespace
+
+TEST(SequenceRingTest, StagesProcessEventsInPlaceInOrder) {
+    constexpr int64_t n = 5000;
+    SequenceRing<Event, 64> ring;
+    auto& decode = ring.add_stage();
+    auto& enrich = ring.add_stage({&decode});
+    auto& persist = ring.add_stage({&enrich});
+
+    std::thread decoder([&]() {
+        while (decode.process(
+            [](Event& e, int64_t) { e.decoded = e.raw * 2; })) {
+        }
+    });
+    std::thread enricher([&]() {
+        while (enrich.process([](Event& e, int64_t) {
+            e.enriched = e.decoded + 1;
+        })) {
+        }
+    });
+
+    std::vector<int64_t> persisted;
+    persisted.reserve(n);
+    std::thread persister([&]() {
+        while (persist.process([&](Event& e, int64_t seq) {
+            EXPECT_EQ(e.raw, seq);
+            persisted.push_back(e.enriched);
+        })) {
+        }
+    });
+
+    for (int64_t i = 0; i < n; ++i) {
+        const int64_t seq = ring.claim();
+        ring[seq] = Event{i, 0, 0};
+        ring.publish(seq);
+    }
+    ring.close();
+
+    decoder.join();
+    enricher.join();
+    persister.join();
+
+    ASSERT_EQ(persisted.size(), static_cast<size_t>(n));
+    for (int64_t i = 0; i < n; ++i) {
+        EXPECT_EQ(persisted[i], i * 2 + 1);
+    }
+    EXPECT_EQ(persist.cursor(), n - 1);
+}
+
+TEST(SequenceRingTest, DependentStageNeverOvertakesItsDependency) {
+    constexpr int64_t n = 4000;
+    SequenceRing<int64_t, 16> ring;
+    auto& first = ring.add_stage();
+    auto& second = ring.add_stage({&first});
+
+    std::atomic<bool> overtaken{false};
+    std::thread a([&]() {
+        while (first.process([](int64_t&, int64_t) {})) {
+        }
+    });
+    std::thread b([&]() {
+        while (second.process([&](int64_t&, int64_t seq) {
+            if (first.cursor() < seq) overtaken.store(true);
+        })) {
+        }
+    });
+
+    for (int64_t i = 0; i < n; ++i) {
+        const int64_t seq = ring.claim();
+        ring[seq] = i;
+        ring.publish(seq);
+    }
+    ring.close();
+    a.join();
+    b.join();
+
+    EXPECT_FALSE(overtaken.load());
+    EXPECT_EQ(second.cursor(), n - 1);
+}
+
+TEST(SequenceRingTest, ProducerIsGatedBySlowestTerminalStage) {
+    SequenceRing<int, 4> ring;
+    auto& fast = ring.add_stage();
+    auto& slow = ring.add_stage();
+
+    for (int i = 0; i < 4; ++i) {
+        auto seq = ring.try_claim();
+        ASSERT_TRUE(seq.has_value());
+        ring.publish(*seq);
+    }
+
+    fast.commit(3);
+    EXPECT_FALSE(ring.try_claim().has_value());
+
+    std::atomic<bool> claimed{false};
+    std::thread producer([&]() {
+        const int64_t seq = ring.claim();
+        ring.publish(seq);
+        claimed.store(true);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(claimed.load());
+
+    slow.commit(0);
+    producer.join();
+    EXPECT_TRUE(claimed.load());
+}
+
+TEST(SequenceRingTest, CloseStopsStagesAfterDrain) {
+    SequenceRing<int, 8> ring;
+    auto& stage = ring.add_stage();
+
+    for (int i = 0; i < 3; ++i) {
+        const int64_t seq = ring.claim();
+        ring[seq] = i;
+        ring.publish(seq);
+    }
+    ring.close();
+
+    int seen = 0;
+    while (stage.process([&](int& v, int64_t) { EXPECT_EQ(v, seen++); })) {
+    }
+    EXPECT_EQ(seen, 3);
+    EXPECT_FALSE(stage.wait_for(3).has_value());
+}
+
+TEST(SequenceRingTest, AddingStagesAfterClaimThrows) {
+    SequenceRing<int, 2> ring;
+    ring.add_stage();
+    ring.claim();
+    EXPECT_THROW(ring.add_stage(), std::logic_error);
+}
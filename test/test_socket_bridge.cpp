@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <channel/socket_bridge.hpp>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct SocketPair {
+    int fds[2]{-1, -1};
+
+    SocketPair() {
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            throw std::system_error(errno, std::generic_category(),
+                                    "socketpair");
+        }
+    }
+    ~SocketPair() {
+        ::close(fds[0]);
+        ::close(fds[1]);
+    }
+};
+
+struct StringSerializer {
+    void serialize(const std::string& value, std::string& out) const {
+        out += value;
+    }
+    std::string deserialize(const char* data, std::size_t size) const {
+        return std::string(data, size);
+    }
+};
+
+}  // namespace
+
+TEST(SocketBridgeTest, MessagesCrossTheSocketInOrder) {
+    constexpr int n = 10000;
+    SocketPair sp;
+    Channel<int, 64> local;
+    Channel<int, 64> remote;
+    SocketBridge<Channel<int, 64>> out(sp.fds[0]);
+    SocketBridge<Channel<int, 64>> in(sp.fds[1]);
+
+    std::thread writer([&]() { out.send_from(local); });
+    std::thread reader([&]() { in.receive_into(remote); });
+
+    std::thread producer([&]() {
+        for (int i = 0; i < n; ++i) {
+            local.send(i);
+        }
+        local.close();
+    });
+
+    std::vector<int> received;
+    while (auto value = remote.receive()) {
+        received.push_back(*value);
+    }
+
+    producer.join();
+    writer.join();
+    reader.join();
+
+    ASSERT_EQ(received.size(), static_cast<size_t>(n));
+    for (int i = 0; i < n; ++i) {
+        EXPECT_EQ(received[i], i);
+    }
+    EXPECT_EQ(out.messages_sent(), static_cast<uint64_t>(n));
+    EXPECT_EQ(in.messages_received(), static_cast<uint64_t>(n));
+}
+
+TEST(SocketBridgeTest, CoalescesBufferedMessagesPerSyscall) {
+    constexpr int n = 64;
+    SocketPair sp;
+    Channel<int, 64> local;
+    Channel<int, 128> remote;
+    SocketBridge<Channel<int, 64>> out(sp.fds[0]);
+    SocketBridge<Channel<int, 128>> in(sp.fds[1]);
+
+    for (int i = 0; i < n; ++i) {
+        local.send(i);
+    }
+    local.close();
+    EXPECT_EQ(out.send_from(local), static_cast<size_t>(n));
+    EXPECT_EQ(out.send_calls(), 1u);
+
+    EXPECT_EQ(in.receive_into(remote), static_cast<size_t>(n));
+    EXPECT_LT(in.receive_calls(), static_cast<uint64_t>(n));
+    EXPECT_TRUE(remote.is_closed());
+}
+
+TEST(SocketBridgeTest, PluggableSerializerHandlesVariableFrames) {
+    SocketPair sp;
+    Channel<std::string, 8> local;
+    Channel<std::string, 8> remote;
+    SocketBridgeOptions options;
+    options.receive_buffer = 16;  // forces frames to span reads
+    SocketBridge<Channel<std::string, 8>, StringSerializer> out(sp.fds[0]);
+    SocketBridge<Channel<std::string, 8>, StringSerializer> in(sp.fds[1], {},
+                                                               options);
+
+    std::thread writer([&]() { out.send_from(local); });
+    std::thread reader([&]() { in.receive_into(remote); });
+
+    const std::vector<std::string> messages{
+        "", "a", std::string(100, 'x'), "hello world", std::string(5000, 'z')};
+    for (const auto& m : messages) {
+        local.send(m);
+    }
+    local.close();
+
+    std::vector<std::string> received;
+    while (auto value = remote.receive()) {
+        received.push_back(*value);
+    }
+    writer.join();
+    reader.join();
+
+    EXPECT_EQ(received, messages);
+}
+
+TEST(SocketBridgeTest, SlowPeerBackpressuresProducers) {
+    SocketPair sp;
+    int small = 4096;
+    ::setsockopt(sp.fds[0], SOL_SOCKET, SO_SNDBUF, &small, sizeof(small));
+    ::setsockopt(sp.fds[1], SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+
+    struct Blob {
+        char bytes[1024];
+    };
+    Channel<Blob, 4> local;
+    Channel<Blob, 4> remote;
+    SocketBridge<Channel<Blob, 4>> out(sp.fds[0]);
+    SocketBridge<Channel<Blob, 4>> in(sp.fds[1]);
+
+    constexpr int n = 256;
+    std::atomic<int> sent{0};
+    std::thread writer([&]() { out.send_from(local); });
+    std::thread producer([&]() {
+        for (int i = 0; i < n; ++i) {
+            local.send(Blob{});
+            sent.fetch_add(1);
+        }
+        local.close();
+    });
+
+    // Nobody reads the peer socket yet, so the producer must stall.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_LT(sent.load(), n);
+
+    std::thread reader([&]() { in.receive_into(remote); });
+    int received = 0;
+    while (remote.receive()) {
+        ++received;
+    }
+
+    producer.join();
+    writer.join();
+    reader.join();
+    EXPECT_EQ(received, n);
+}
+
+TEST(SocketBridgeTest, WriteFailureClosesTheChannelForProducers) {
+    using Local = Channel<int, 4, SlotLayout::Padded>;
+    SocketPair sp;
+    ::close(sp.fds[1]);
+    sp.fds[1] = -1;
+    Local local;
+    SocketBridge<Local> out(sp.fds[0]);
+
+    std::atomic<bool> rejected{false};
+    std::thread producer([&]() {
+        try {
+            while (true) {
+                local.send(1);
+            }
+        } catch (const Local::send_after_close&) {
+            rejected = true;
+        }
+    });
+    EXPECT_THROW(out.send_from(local), std::system_error);
+    producer.join();
+    EXPECT_TRUE(rejected.load());
+    EXPECT_TRUE(local.is_closed());
+}
+
+TEST(SocketBridgeTest, OversizedFramesAreRejected) {
+    using Strings = Channel<std::string, 8>;
+    SocketBridgeOptions options;
+    options.max_frame_size = 64;
+
+    SocketPair sp;
+    Strings local;
+    SocketBridge<Strings, StringSerializer> out(sp.fds[0], {}, options);
+    local.send(std::string(65, 'x'));
+    local.close();
+    EXPECT_THROW(out.send_from(local), std::length_error);
+
+    // A peer announcing a huge frame is cut off before anything is buffered
+    // for it.
+    SocketPair raw;
+    const uint32_t length = 0xfffffff0u;
+    ASSERT_EQ(::write(raw.fds[0], &length, sizeof(length)),
+              static_cast<ssize_t>(sizeof(length)));
+    Strings remote;
+    SocketBridge<Strings, StringSerializer> in(raw.fds[1], {}, options);
+    EXPECT_THROW(in.receive_into(remote), std::runtime_error);
+    EXPECT_TRUE(remote.is_closed());
+}
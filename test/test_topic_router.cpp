@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <channel/topic_router.hpp>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Inbox = Channel<int, 64>;
+
+namespace {
+
+std::size_t drain(Inbox& inbox) {
+    std::vector<int> out;
+    return inbox.try_receive_batch(std::back_inserter(out), 64);
+}
+
+}  // namespace
+
+TEST(TopicRouterTest, WildcardsMatchLikeMqtt) {
+    TopicRouter<Inbox> router;
+    const std::vector<std::string> patterns{
+        "a/b/c", "a/+/c", "a/#", "#", "+/b", "a/b/c/#", "a/b", "b/#"};
+    std::vector<std::shared_ptr<Inbox>> inboxes;
+    for (const auto& pattern : patterns) {
+        inboxes.push_back(std::make_shared<Inbox>());
+        router.subscribe(pattern, inboxes.back());
+    }
+    auto matched = [&](const std::string& topic) {
+        router.publish(topic, 1);
+        std::vector<std::string> got;
+        for (std::size_t i = 0; i < inboxes.size(); ++i) {
+            if (drain(*inboxes[i]) > 0) got.push_back(patterns[i]);
+        }
+        return got;
+    };
+    EXPECT_EQ(matched("a/b/c"), (std::vector<std::string>{
+                                    "a/b/c", "a/+/c", "a/#", "#", "a/b/c/#"}));
+    EXPECT_EQ(matched("a/b"),
+              (std::vector<std::string>{"a/#", "#", "+/b", "a/b"}));
+    EXPECT_EQ(matched("a"), (std::vector<std::string>{"a/#", "#"}));
+    EXPECT_EQ(matched("c/b/x"), (std::vector<std::string>{"#"}));
+    // A second publish is served from the cache and must agree.
+    EXPECT_EQ(matched("a/b"),
+              (std::vector<std::string>{"a/#", "#", "+/b", "a/b"}));
+}
+
+TEST(TopicRouterTest, SubscriptionChangesInvalidateCachedTopics) {
+    TopicRouter<Inbox> router;
+    auto first = std::make_shared<Inbox>();
+    auto second = std::make_shared<Inbox>();
+    const auto id = router.subscribe("site/+/temp", first);
+    EXPECT_EQ(router.publish("site/7/temp", 1), 1u);
+
+    router.subscribe("site/7/#", second);
+    EXPECT_EQ(router.publish("site/7/temp", 2), 2u);
+
+    EXPECT_TRUE(router.unsubscribe(id));
+    EXPECT_FALSE(router.unsubscribe(id));
+    EXPECT_EQ(router.publish("site/7/temp", 3), 1u);
+    EXPECT_EQ(drain(*first), 2u);
+    EXPECT_EQ(drain(*second), 2u);
+    EXPECT_EQ(router.subscriptions(), 1u);
+
+    // Same pattern again after its branch was pruned.
+    router.subscribe("site/+/temp", first);
+    EXPECT_EQ(router.publish("site/7/temp", 4), 2u);
+}
+
+TEST(TopicRouterTest, RejectsMalformedPatternsAndWildcardTopics) {
+    TopicRouter<Inbox> router;
+    auto inbox = std::make_shared<Inbox>();
+    EXPECT_THROW(router.subscribe("a/#/b", inbox), std::invalid_argument);
+    EXPECT_THROW(router.subscribe("a/b+", inbox), std::invalid_argument);
+    EXPECT_THROW(router.subscribe("a/x#", inbox), std::invalid_argument);
+    EXPECT_THROW(router.subscribe("a", nullptr), std::invalid_argument);
+    EXPECT_THROW(router.publish("a/+", 1), std::invalid_argument);
+    EXPECT_EQ(router.subscriptions(), 0u);
+}
+
+TEST(TopicRouterTest, BatchReachesEverySubscriberAndSkipsClosedOnes) {
+    TopicRouter<Inbox> router({0});
+    auto open = std::make_shared<Inbox>();
+    auto closed = std::make_shared<Inbox>();
+    router.subscribe("jobs/#", open);
+    router.subscribe("jobs/+", closed);
+    closed->close();
+
+    const std::vector<int> batch{1, 2, 3, 4, 5};
+    EXPECT_EQ(router.publish_batch("jobs/x", batch), 1u);
+    std::vector<int> out;
+    open->try_receive_batch(std::back_inserter(out), 64);
+    EXPECT_EQ(out, batch);
+}
+
+TEST(TopicRouterTest, ConcurrentPublishersAndSubscriptionChurn) {
+    TopicRouter<Inbox> router({4});
+    auto steady = std::make_shared<Inbox>();
+    router.subscribe("t/#", steady);
+
+    std::atomic<bool> done{false};
+    std::atomic<long> received{0};
+    std::thread consumer([&]() {
+        std::vector<int> out;
+        while (true) {
+            out.clear();
+            const auto got =
+                steady->receive_batch(std::back_inserter(out), 64);
+            if (got == 0) break;
+            received += static_cast<long>(got);
+        }
+    });
+    std::thread churn([&]() {
+        auto extra = std::make_shared<Inbox>();
+        while (!done.load()) {
+            const auto id = router.subscribe("t/+", extra);
+            drain(*extra);
+            router.unsubscribe(id);
+        }
+    });
+    constexpr int per_publisher = 5000;
+    std::vector<std::thread> publishers;
+    for (int p = 0; p < 2; ++p) {
+        publishers.emplace_back([&, p]() {
+            for (int i = 0; i < per_publisher; ++i) {
+                router.publish("t/" + std::to_string((p * 7 + i) % 10), i);
+            }
+        });
+    }
+    for (auto& t : publishers) t.join();
+    done = true;
+    churn.join();
+    steady->close();
+    consumer.join();
+    EXPECT_EQ(received.load(), 2 * per_publisher);
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <channel/tsc_clock.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+
+TEST(TscClockTest, NeverGoesBackwardsOnOneThread) {
+    auto previous = TscClock::now();
+    for (int i = 0; i < 100000; ++i) {
+        const auto current = TscClock::now();
+        ASSERT_GE(current, previous);
+        previous = current;
+    }
+}
+
+TEST(TscClockTest, TracksSteadyClock) {
+    TscClock::calibrate();
+    const auto steady_start = std::chrono::steady_clock::now();
+    const auto tsc_start = TscClock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const auto tsc_elapsed = TscClock::now() - tsc_start;
+    const auto steady_elapsed = std::chrono::steady_clock::now() - steady_start;
+
+    // The coarse fallback only moves once per kernel tick.
+    const auto tolerance = TscClock::source() == TscClock::Source::Tsc
+                               ? std::chrono::milliseconds(2)
+                               : std::chrono::milliseconds(20);
+    const auto diff = tsc_elapsed - steady_elapsed;
+    EXPECT_LT(diff < diff.zero() ? -diff : diff, tolerance);
+}
+
+TEST(TscClockTest, SharesSteadyClockEpoch) {
+    const int64_t tsc = TscClock::now().time_since_epoch().count();
+    const int64_t steady =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    EXPECT_LT(std::abs(steady - tsc), 50000000);
+}
+
+TEST(TscClockTest, StaysCloseToSteadyClockOverTime) {
+    TscClock::calibrate();
+    auto offset_ns = []() {
+        // Smallest gap over a few paired readings, to shrug off preemption.
+        int64_t best = INT64_MAX;
+        for (int i = 0; i < 5; ++i) {
+            const int64_t steady =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                    .count();
+            const int64_t tsc = TscClock::now().time_since_epoch().count();
+            best = std::min(best, std::abs(tsc - steady));
+        }
+        return best;
+    };
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(1500);
+    while (std::chrono::steady_clock::now() < deadline) {
+        TscClock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    // A one-off calibration drifts by tens of ppm or more; re-anchoring
+    // keeps the gap to microseconds.
+    const int64_t tolerance =
+        TscClock::source() == TscClock::Source::Tsc ? 200000 : 20000000;
+    EXPECT_LT(offset_ns(), tolerance);
+}
@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <channel/counting_resource.hpp>
+#include <channel/unbounded_channel.hpp>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using UnboundedInt = UnboundedChannel<int, 8>;
+
+TEST(UnboundedChannelTest, FifoAcrossSegmentsForSingleConsumer) {
+    UnboundedInt ch;
+    for (int i = 0; i < 100; ++i) {
+        ch.send(i);
+    }
+    for (int i = 0; i < 100; ++i) {
+        auto value = ch.receive();
+        ASSERT_TRUE(value.has_value());
+        EXPECT_EQ(*value, i);
+    }
+    auto [result, value] = ch.try_receive();
+    EXPECT_EQ(result, UnboundedInt::RecvResult::Empty);
+    EXPECT_FALSE(value.has_value());
+}
+
+TEST(UnboundedChannelTest, ManyProducersManyConsumersDeliverEachItemOnce) {
+    constexpr int producers = 4;
+    constexpr int consumers = 4;
+    constexpr int per_producer = 20000;
+    constexpr int total = producers * per_producer;
+    UnboundedChannel<int, 32> ch;
+
+    std::vector<std::atomic<int>> counts(total);
+    std::vector<std::thread> threads;
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&]() {
+            while (auto value = ch.receive()) {
+                counts[*value].fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    std::vector<std::thread> senders;
+    for (int p = 0; p < producers; ++p) {
+        senders.emplace_back([&, p]() {
+            for (int i = 0; i < per_producer; ++i) {
+                ch.send(p * per_producer + i);
+            }
+        });
+    }
+    for (auto& t : senders) {
+        t.join();
+    }
+    ch.close();
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (int i = 0; i < total; ++i) {
+        ASSERT_EQ(counts[i].load(), 1) << "item " << i;
+    }
+}
+
+TEST(UnboundedChannelTest, SegmentTurnoverOnEveryItemIsSafe) {
+    // One slot per segment: nearly every send links a segment and nearly
+    // every receive retires one, racing the producers' tail updates.
+    constexpr int producers = 8;
+    constexpr int consumers = 8;
+    constexpr int per_producer = 5000;
+    constexpr int total = producers * per_producer;
+    UnboundedChannel<int, 1> ch;
+
+    std::vector<std::atomic<int>> counts(total);
+    std::vector<std::thread> threads;
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&]() {
+            while (auto value = ch.receive()) {
+                counts[*value].fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    std::vector<std::thread> senders;
+    for (int p = 0; p < producers; ++p) {
+        senders.emplace_back([&, p]() {
+            for (int i = 0; i < per_producer; ++i) {
+                ch.send(p * per_producer + i);
+            }
+        });
+    }
+    for (auto& t : senders) {
+        t.join();
+    }
+    ch.close();
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (int i = 0; i < total; ++i) {
+        ASSERT_EQ(counts[i].load(), 1) << "item " << i;
+    }
+}
+
+TEST(UnboundedChannelTest, ParkedConsumerWakesOnSend) {
+    UnboundedInt ch;
+    std::atomic<int> got{-1};
+    std::thread consumer([&]() { got.store(ch.receive().value_or(-2)); });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_EQ(got.load(), -1);
+    ch.send(7);
+    consumer.join();
+    EXPECT_EQ(got.load(), 7);
+}
+
+TEST(UnboundedChannelTest, CloseDrainsThenStops) {
+    UnboundedInt ch;
+    ch.send(1);
+    ch.send(2);
+    ch.close();
+
+    EXPECT_THROW(ch.send(3), std::runtime_error);
+    EXPECT_EQ(ch.try_send(3), UnboundedInt::SendResult::Closed);
+    EXPECT_EQ(ch.receive().value(), 1);
+    EXPECT_EQ(ch.try_receive().second.value(), 2);
+    EXPECT_FALSE(ch.receive().has_value());
+    EXPECT_EQ(ch.try_receive().first, UnboundedInt::RecvResult::Closed);
+}
+
+TEST(UnboundedChannelTest, CloseWakesParkedConsumers) {
+    UnboundedInt ch;
+    std::vector<std::thread> consumers;
+    std::atomic<int> finished{0};
+    for (int i = 0; i < 3; ++i) {
+        consumers.emplace_back([&]() {
+            EXPECT_FALSE(ch.receive().has_value());
+            finished.fetch_add(1);
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    ch.close();
+    for (auto& t : consumers) {
+        t.join();
+    }
+    EXPECT_EQ(finished.load(), 3);
+}
+
+TEST(UnboundedChannelTest, RetiredSegmentsAreReclaimed) {
+    const uint64_t before = EpochDomain::instance().reclaimed();
+    {
+        UnboundedChannel<int, 4> ch;
+        for (int round = 0; round < 200; ++round) {
+            for (int i = 0; i < 16; ++i) {
+                ch.send(i);
+            }
+            for (int i = 0; i < 16; ++i) {
+                ch.receive();
+            }
+        }
+    }
+    EpochDomain::instance().collect();
+    EpochDomain::instance().collect();
+    EXPECT_GT(EpochDomain::instance().reclaimed(), before);
+}
+
+TEST(UnboundedChannelTest, DestructorReleasesBufferedItems) {
+    auto payload = std::make_shared<std::string>("held");
+    {
+        UnboundedChannel<std::shared_ptr<std::string>, 4> ch;
+        for (int i = 0; i < 10; ++i) {
+            ch.send(payload);
+        }
+        ch.receive();
+        EXPECT_EQ(payload.use_count(), 10);
+    }
+    EXPECT_EQ(payload.use_count(), 1);
+}
+
+TEST(UnboundedChannelTest, SegmentsComeFromTheGivenResource) {
+    // Retired segments are freed by EpochDomain later on, so the resource
+    // must outlive the channel.
+    static CountingResource counting;
+    const uint64_t before = counting.allocations();
+    {
+        UnboundedChannel<int, 4> ch(&counting);
+        EXPECT_EQ(ch.memory_resource(), &counting);
+        for (int i = 0; i < 64; ++i) {
+            ch.send(i);
+        }
+        EXPECT_GE(counting.allocations() - before, 16u);
+        for (int i = 0; i < 64; ++i) {
+            EXPECT_EQ(ch.receive(), i);
+        }
+    }
+    for (int i = 0; i < 10 && counting.bytes_in_use() != 0; ++i) {
+        EpochDomain::instance().collect();
+    }
+    EXPECT_EQ(counting.bytes_in_use(), 0u);
+    EXPECT_EQ(counting.allocations(), counting.deallocations());
+}